@@ -2,28 +2,78 @@
 
 using namespace llvm;
 
+static cl::opt<visit_order> SeminalVisitOrder(
+    "seminal-order", cl::desc("Order the def-use search discovers variables in"),
+    cl::values(clEnumValN(VISIT_BFS, "bfs", "breadth first (default)"),
+               clEnumValN(VISIT_DFS, "dfs", "depth first, smaller worklists")),
+    cl::init(VISIT_BFS));
+
+static cl::opt<search_mode> SeminalMode(
+    "seminal-mode", cl::desc("How inputs are traced to the branches"),
+    cl::values(clEnumValN(SEARCH_BACKWARD, "backward", "search back from each branch (default)"),
+               clEnumValN(SEARCH_FORWARD, "forward", "push every input through the whole module once")),
+    cl::init(SEARCH_BACKWARD));
+
+static cl::opt<def_mode> SeminalDefs(
+    "seminal-defs", cl::desc("Which assignments a variable's value can come from"),
+    cl::values(clEnumValN(DEFS_LINES, "lines", "every assignment in the function (default)"),
+               clEnumValN(DEFS_REACHING, "reaching", "only the assignments that reach the line it is read on")),
+    cl::init(DEFS_LINES));
+
+static cl::opt<ir_mode> SeminalIR(
+    "seminal-ir", cl::desc("Which form of the IR is analyzed"),
+    cl::values(clEnumValN(IR_MEMORY, "memory", "before optimization, variables in allocas (default)"),
+               clEnumValN(IR_SSA, "ssa", "after optimization, variables in SSA values")),
+    cl::init(IR_MEMORY));
+
+static cl::opt<unsigned> SeminalContext(
+    "seminal-context", cl::desc("Calls kept in a calling context, so a parameter only gets its value from the call it was entered by (0: every caller)"),
+    cl::init(0));
+
+static cl::opt<unsigned> SeminalContextLimit(
+    "seminal-context-limit", cl::desc("Most calling contexts before falling back to every caller"),
+    cl::init(4096));
+
+static cl::opt<bool> SeminalDemand(
+    "seminal-demand", cl::desc("Only walk the functions of the branches and the ones the search reaches from them"),
+    cl::init(false));
+
+static cl::opt<std::string> SeminalBranchInfo(
+    "seminal-branch-info", cl::desc("File listing the branch lines to analyze, every branch if not given"),
+    cl::init(""));
+
+static cl::opt<std::string> SeminalDefUseOut(
+    "seminal-def-use-out", cl::desc("File the def-use trace is written to, none by default"),
+    cl::init(""));
+
+static cl::opt<unsigned> SeminalThreads(
+    "seminal-threads", cl::desc("Threads collecting facts and answering branch queries (1: no threads)"),
+    cl::init(1));
+
+static cl::opt<bool> SeminalStats(
+    "seminal-stats", cl::desc("Print def-use search statistics"), cl::init(false));
+
 namespace {
-    struct SeminalPass : public PassInfoMixin<SeminalPass> {
+    // The analysis of one module. All state, including the facts in
+    // analysis_state, lives in this object.
+    struct module_analysis : analysis_state {
     private:
-        std::map<Value*, std::string> varNames;
-        std::map<Value*, DILocalVariable*> debugVars;
-        string current_scope = "global";
+        std::unordered_map<const Function*, function_debug_vars> debug_index;  // built once per function
+        std::unordered_map<const Value*, DIGlobalVariable*> global_debug_vars;
+        StringMap<GlobalVariable*> globals_by_name;         // global with debug info -> its variable
+        std::unordered_set<const DISubprogram*> outlined;   // subprograms of the functions the module defines
+        source_cache sources;   // source text of every file we need to look at
+        const DataLayout *layout = nullptr;
+        Module *module = nullptr;
 
         void analyzeGlobalVariables(Module &M) {
             for (GlobalVariable &GV : M.globals()) {
                 if (DIGlobalVariableExpression* DIGVE = dyn_cast_or_null<DIGlobalVariableExpression>(
                         GV.getMetadata(LLVMContext::MD_dbg))) {
                     DIGlobalVariable *DGV = DIGVE->getVariable();
-                    
-                    var_map vm;
-                    vm.name = DGV->getName().str();
-                    vm.scope = "global";
-                    vm.defined_at_line = DGV->getLine();
-                    vm.gets_value_infos = std::vector<get_list>();
-                    variable_infos.push_back(vm);
-                    
-                    // Track the name for later use
-                    varNames[&GV] = DGV->getName().str();
+                    add_variable_info(names.intern(DGV->getName()), SYM_GLOBAL, DGV->getLine());
+                    if (isPointerType(DGV->getType()))
+                        indexes.pointer_vars.insert(sym_pair(names.intern(DGV->getName()), SYM_GLOBAL));
 
                     // Check initializer
                     if (GV.hasInitializer()) {
@@ -33,85 +83,363 @@ namespace {
             }
         }
 
-        void printFunctionHeader(Function& F) {
+        void printFunctionHeader(Function& F, function_facts &ff) {
             DISubprogram* SP = F.getSubprogram();
             unsigned line = SP ? SP->getLine() : 0;
         
-            func_map fm;
-            fm.line_num = line;
-            fm.name = F.getName().str();
-            fm.args = std::vector<param>();
-
-            current_scope = F.getName().str();
+            ff.scope = ff.names.intern(F.getName());
 
+            SmallVector<param, 8> args;
             for (auto& Arg : F.args()) {
                 if (DILocalVariable* DV = findArgDebugInfo(&Arg)) {
-                    fm.args.push_back({Arg.getArgNo(), DV->getName().str()});
+                    args.push_back({(int)Arg.getArgNo(), ff.names.intern(DV->getName())});
                 } else {
                     // Handle case where debug info isn't available
                     // Use a default name based on argument position
                     std::string defaultName = "arg" + std::to_string(Arg.getArgNo());
-                    fm.args.push_back({Arg.getArgNo(), defaultName});
+                    args.push_back({(int)Arg.getArgNo(), ff.names.intern(defaultName)});
                 }
             }
 
-            functions.push_back(fm);
+            ff.functions.add(line, ff.scope, args);
+        }
+
+        // walk F once and index every debug variable by the value it describes.
+        // When functions are walked on threads, every function has its entry
+        // before they start, and each thread only builds its own.
+        const function_debug_vars& getDebugVars(const Function* F) {
+            auto it = debug_index.find(F);
+            if (it == debug_index.end()) it = debug_index.emplace(F, function_debug_vars()).first;
+            function_debug_vars &dv = it->second;
+            if (dv.built) return dv;
+            dv.built = true;
+
+            auto add = [&](Value* V, DILocalVariable* Var, const DIExpression* Expr, const DILocation* Loc, bool isDeclare) {
+                if (!Var || !Loc) return;
+                // a variable left in memory by optimization may be described
+                // by a dbg.value of its address, dereferenced
+                if (!isDeclare && isa_and_nonnull<AllocaInst>(V) && Expr && Expr->startsWithDeref()) isDeclare = true;
+                const DILocation* Call = Loc->getInlinedAt();
+                if (Call && Var->getArg() && !isDeclare && V)
+                    dv.inlined_args.push_back({Call, Var, V});
+                if (!ownVariable(Var, Loc)) return;
+                if (Var->getArg() && !Call) dv.args.emplace(Var->getArg(), Var);
+                if (!V) return;
+                if (isDeclare) {
+                    dv.declared.emplace(V, Var);
+                } else {
+                    auto &vars = dv.values[V];
+                    if (std::find(vars.begin(), vars.end(), Var) == vars.end()) vars.push_back(Var);
+                }
+            };
+            for (const BasicBlock &BB : *F) {
+                for (const Instruction &I : BB) {
+#if LLVM_VERSION_MAJOR >= 19
+                    for (DbgVariableRecord &DVR : filterDbgVars(I.getDbgRecordRange())) {
+                        if (DVR.isDbgDeclare()) add(DVR.getAddress(), DVR.getVariable(), DVR.getExpression(), DVR.getDebugLoc().get(), true);
+                        else if (DVR.isDbgValue()) add(DVR.getValue(), DVR.getVariable(), DVR.getExpression(), DVR.getDebugLoc().get(), false);
+                    }
+#endif
+                    if (const DbgDeclareInst *DDI = dyn_cast<DbgDeclareInst>(&I))
+                        add(DDI->getAddress(), DDI->getVariable(), DDI->getExpression(), DDI->getDebugLoc().get(), true);
+                    else if (const DbgValueInst *DVI = dyn_cast<DbgValueInst>(&I))
+                        add(DVI->getValue(), DVI->getVariable(), DVI->getExpression(), DVI->getDebugLoc().get(), false);
+
+                    for (const DILocation* Loc = I.getDebugLoc().get(); Loc && Loc->getInlinedAt(); Loc = Loc->getInlinedAt()) {
+                        const DISubprogram* SP = Loc->getScope()->getSubprogram();
+                        if (!outlined.count(SP) && std::find(dv.removed.begin(), dv.removed.end(), SP) == dv.removed.end())
+                            dv.removed.push_back(SP);
+                    }
+                }
+            }
+            return dv;
         }
 
         DILocalVariable* findArgDebugInfo(Argument* Arg) {
             Function* F = Arg->getParent();
             if (!F->getSubprogram()) return nullptr;
+
+            const function_debug_vars &dv = getDebugVars(F);
+            auto it = dv.args.find(Arg->getArgNo() + 1);
+            return it == dv.args.end() ? nullptr : it->second;
+        }
+
+        // the local variable whose address is V (the alloca of a dbg.declare)
+        DILocalVariable* findDeclaredVariable(const Value *V) {
+            const Function *F = nullptr;
+            if (const Instruction *I = dyn_cast<Instruction>(V))
+                F = I->getFunction();
+            else if (const Argument *Arg = dyn_cast<Argument>(V))
+                F = Arg->getParent();
             
-            unsigned ArgNo = Arg->getArgNo();
-            
-            for (BasicBlock& BB : *F) {
-                for (Instruction& I : BB) {
-                    if (DbgDeclareInst* DDI = dyn_cast<DbgDeclareInst>(&I)) {
-                        DILocalVariable* DV = DDI->getVariable();
-                        if (DV && DV->getArg() == ArgNo + 1) {
-                            return DV;
-                        }
-                    }
+            if (!F) return nullptr;
+
+            const function_debug_vars &dv = getDebugVars(F);
+            auto it = dv.declared.find(V);
+            return it == dv.declared.end() ? nullptr : it->second;
+        }
+
+        // the variables the SSA value V holds, from the dbg.values describing
+        // it. A temporary no dbg.value describes holds the variables it is
+        // computed from, including those whose address it is computed from;
+        // what is loaded or returned by a call is left to the load or the call,
+        // unless the load was hoisted away from any line, when its address is
+        // followed too.
+        void describedVariables(const Value *V, SmallVectorImpl<DILocalVariable*> &out) {
+            SmallVector<const Value*, 4> work = {V};
+            SmallPtrSet<const Value*, 8> seen;
+            while (!work.empty()) {
+                const Value *W = work.pop_back_val();
+                if (!seen.insert(W).second) continue;
+                const Function *F = nullptr;
+                if (const Instruction *I = dyn_cast<Instruction>(W)) F = I->getFunction();
+                else if (const Argument *Arg = dyn_cast<Argument>(W)) F = Arg->getParent();
+                if (!F) continue;
+
+                const function_debug_vars &dv = getDebugVars(F);
+                auto it = dv.values.find(W);
+                if (W != V && isa<AllocaInst>(W)) {
+                    DILocalVariable *Var = findDeclaredVariable(W);
+                    if (Var && std::find(out.begin(), out.end(), Var) == out.end()) out.push_back(Var);
+                } else if (it != dv.values.end()) {
+                    for (DILocalVariable *Var : it->second)
+                        if (std::find(out.begin(), out.end(), Var) == out.end()) out.push_back(Var);
+                } else if (const LoadInst *LI = dyn_cast<LoadInst>(W)) {
+                    if (!LI->getDebugLoc()) work.push_back(LI->getPointerOperand());
+                } else if (isa<Instruction>(W) && !isa<CallBase>(W) && !isa<AllocaInst>(W)) {
+                    for (const Value *Op : cast<Instruction>(W)->operands()) work.push_back(Op);
                 }
             }
+        }
+
+        // where code at Loc is in the source. Code inlined from a function
+        // the module still defines is part of the call it was inlined from;
+        // code of a function that was inlined and removed is still its own.
+        DILocation* sourceLocation(DILocation* Loc) {
+            while (Loc && Loc->getInlinedAt() && outlined.count(Loc->getScope()->getSubprogram()))
+                Loc = Loc->getInlinedAt();
+            return Loc;
+        }
+
+        DILocation* sourceLocation(const Instruction &I) { return sourceLocation(I.getDebugLoc().get()); }
+
+        // where code at Loc is in SP's code: Loc itself, or the call in SP it
+        // was inlined from; null if it is not in SP at all
+        DILocation* locationIn(DILocation* Loc, const DISubprogram* SP) {
+            for (; Loc; Loc = Loc->getInlinedAt())
+                if (Loc->getScope()->getSubprogram() == SP) return Loc;
             return nullptr;
         }
 
-        void printDbgValueInfo(const DbgDeclareInst* DDI) {
-            if (!DDI) return;
-            
-            DILocalVariable* Var = DDI->getVariable();
-            DILocation* Loc = DDI->getDebugLoc().get();
-            var_map vm;
-            if (Var && Loc) {
-                varNames[DDI->getAddress()] = Var->getName().str();
-                debugVars[DDI->getAddress()] = Var;
+        // the line of I in the code of the function Var is declared in, 0 if
+        // I is not in that function's code
+        unsigned lineIn(const Instruction &I, const DILocalVariable* Var) {
+            DILocation* Loc = locationIn(I.getDebugLoc().get(), Var->getScope()->getSubprogram());
+            return Loc ? Loc->getLine() : 0;
+        }
+
+        // whether Var, described at Loc, is a variable of the function the
+        // code is in rather than of a function still defined elsewhere
+        bool ownVariable(const DILocalVariable* Var, const DILocation* Loc) {
+            return !Loc->getInlinedAt() || !outlined.count(Var->getScope()->getSubprogram());
+        }
+
+        sym subprogramScope(const DISubprogram* SP, function_facts &ff) {
+            return ff.names.intern(SP->getLinkageName().empty() ? SP->getName() : SP->getLinkageName());
+        }
+
+        // the scope of code at Loc: the function walked, or the removed
+        // function it was inlined from
+        sym locationScope(const DILocation* Loc, function_facts &ff) {
+            return Loc->getInlinedAt() ? subprogramScope(Loc->getScope()->getSubprogram(), ff) : ff.scope;
+        }
+
+        DIGlobalVariable* findGlobalVariable(const Value *V) {
+            auto it = global_debug_vars.find(V);
+            return it == global_debug_vars.end() ? nullptr : it->second;
+        }
 
-                vm.name = Var->getName().str();
-                vm.scope = current_scope;
-                vm.defined_at_line = Loc->getLine();
-                vm.gets_value_infos = std::vector<get_list>();
-                variable_infos.push_back(vm);
+        void printDbgValueInfo(Value* Address, DILocalVariable* Var, DILocation* Loc, function_facts &ff) {
+            if (Address && Var && Loc && ownVariable(Var, Loc)) {
+                sym name = ff.names.intern(Var->getName());
+                sym scope = locationScope(Loc, ff);
+                ff.var_index.emplace(sym_pair(name, scope), ff.vars.add(name, scope, Loc->getLine()));
+                if (isPointerType(Var->getType())) ff.pointers.push_back({name, scope});
             }
         }
 
-        std::string getVariableName(Value* V) {
-            if (varNames.count(V)) {
-                return varNames[V];
+        // T without typedefs and qualifiers
+        static const DIType* stripTypedefs(const DIType* T) {
+            while (const DIDerivedType* D = dyn_cast_or_null<DIDerivedType>(T)) {
+                unsigned tag = D->getTag();
+                if (tag != dwarf::DW_TAG_typedef && tag != dwarf::DW_TAG_const_type &&
+                    tag != dwarf::DW_TAG_volatile_type && tag != dwarf::DW_TAG_restrict_type) break;
+                T = D->getBaseType();
             }
-            
-            // Try to get name from debug info for arrays
-            if (GetElementPtrInst* GEP = dyn_cast<GetElementPtrInst>(V)) {
-                Value* PtrOp = GEP->getPointerOperand();
-                if (debugVars.count(PtrOp)) {
-                    return debugVars[PtrOp]->getName().str();
+            return T;
+        }
+
+        static bool isPointerType(const DIType* T) {
+            const DIDerivedType* D = dyn_cast_or_null<DIDerivedType>(stripTypedefs(T));
+            return D && D->getTag() == dwarf::DW_TAG_pointer_type;
+        }
+
+        // what a value of type T points to, or the elements of an array T
+        static const DIType* pointeeType(const DIType* T) {
+            T = stripTypedefs(T);
+            if (isPointerType(T)) return cast<DIDerivedType>(T)->getBaseType();
+            if (const DICompositeType* C = dyn_cast_or_null<DICompositeType>(T))
+                if (C->getTag() == dwarf::DW_TAG_array_type) return C->getBaseType();
+            return nullptr;
+        }
+
+        // the member of struct T that starts offset bits into it
+        static const DIDerivedType* memberAt(const DIType* T, uint64_t offset) {
+            const DICompositeType* C = dyn_cast_or_null<DICompositeType>(stripTypedefs(T));
+            if (!C || (C->getTag() != dwarf::DW_TAG_structure_type && C->getTag() != dwarf::DW_TAG_class_type)) return nullptr;
+            for (const DINode* N : C->getElements()) {
+                const DIDerivedType* M = dyn_cast<DIDerivedType>(N);
+                if (M && M->getTag() == dwarf::DW_TAG_member && M->getOffsetInBits() == offset) return M;
+            }
+            return nullptr;
+        }
+
+        // the abstract location Ptr points into: the variable it is an address
+        // in, then the fields and array elements the address steps into, named
+        // from the debug types ("book.count", "accounts[].name"). Every array
+        // index is summarized as [], and so is pointer arithmetic other than by
+        // a constant 0. Going through a pointer adds nothing, so p->f is p.f and
+        // *p is p, the way an array and the pointer it decays to are one name.
+        // An escaping address (stored or passed, not read through) drops the
+        // trailing indexes by 0 of an array decaying to a pointer. Local is the
+        // variable the location starts from, null for a global. "" if Ptr is
+        // not an address in a known variable. Memory is the memory objects the
+        // location may be, from the points-to classes, none if they have no name.
+        std::string locationName(const Value* Ptr, DILocalVariable** Local = nullptr, bool escaping = false,
+                                 vector<string>* Memory = nullptr) {
+            const DIType* Ty = nullptr;
+            DILocalVariable* Var = nullptr;
+            string name;
+            size_t kept = 0, from = 0;
+            if (!resolveLocation(Ptr, name, kept, from, Ty, Var, 0)) return "";
+            if (Local) *Local = Var;
+            if (escaping) name.resize(kept);
+            if (Memory) *Memory = memoryNames(Ptr, StringRef(name).drop_front(std::min(from, name.size())));
+            return name;
+        }
+
+        // locationName's walk: name is the location, Ty its debug type, kept
+        // the length of name without trailing array indexes by 0, and from
+        // where the path from the last pointer gone through starts
+        bool resolveLocation(const Value* Ptr, string &name, size_t &kept, size_t &from, const DIType* &Ty,
+                             DILocalVariable* &Var, int depth) {
+            if (!Ptr || depth > 8) return false;
+            // only casts: stripPointerCasts would also drop a step into the
+            // first field, whose indexes are all 0
+            auto strip = [](const Value* V) {
+                while (isa<BitCastOperator>(V) || isa<AddrSpaceCastOperator>(V)) V = cast<Operator>(V)->getOperand(0);
+                return V;
+            };
+            SmallVector<const GEPOperator*, 4> geps;
+            const Value* B = strip(Ptr);
+            while (const GEPOperator* GEP = dyn_cast<GEPOperator>(B)) {
+                geps.push_back(GEP);
+                B = strip(GEP->getPointerOperand());
+            }
+
+            if (DIGlobalVariable* DGV = findGlobalVariable(B)) {
+                name = DGV->getName().str();
+                Ty = DGV->getType();
+                Var = nullptr;
+            } else if (DILocalVariable* DV = findDeclaredVariable(B)) {
+                name = DV->getName().str();
+                Ty = DV->getType();
+                Var = DV;
+            } else if (const LoadInst* LI = dyn_cast<LoadInst>(B)) {
+                // through a pointer held in a variable or a field
+                if (!resolveLocation(LI->getPointerOperand(), name, kept, from, Ty, Var, depth + 1)) return false;
+                Ty = pointeeType(Ty);
+            } else if (B->getType()->isPointerTy()) {
+                // after mem2reg, a pointer a dbg.value describes
+                SmallVector<DILocalVariable*, 2> vars;
+                describedVariables(B, vars);
+                if (vars.empty()) return false;
+                Var = vars[0];
+                name = Var->getName().str();
+                Ty = pointeeType(Var->getType());
+            } else {
+                return false;
+            }
+            kept = from = name.size();
+
+            const DataLayout &DL = *layout;
+            for (auto it = geps.rbegin(); it != geps.rend(); ++it) {
+                const GEPOperator* GEP = *it;
+                bool first = true;
+                for (gep_type_iterator GTI = gep_type_begin(GEP), E = gep_type_end(GEP); GTI != E; ++GTI, first = false) {
+                    const ConstantInt* C = dyn_cast<ConstantInt>(GTI.getOperand());
+                    if (first) {
+                        // steps over whole objects the pointer points at
+                        if (C && C->isZero()) continue;
+                        // a byte offset into a struct, as optimization leaves them
+                        if (C && GTI.getIndexedType()->isIntegerTy(8) && fieldsAt(Ty, C->getZExtValue() * 8, name)) {
+                            kept = name.size();
+                            continue;
+                        }
+                        if (!StringRef(name).endswith("[]")) name += "[]";
+                        kept = name.size();
+                    } else if (StructType* ST = GTI.getStructTypeOrNull()) {
+                        const DIDerivedType* M = C ? memberAt(Ty, DL.getStructLayout(ST)->getElementOffsetInBits(C->getZExtValue())) : nullptr;
+                        // a field the debug info does not name: the struct as a whole
+                        if (!M) return true;
+                        name += "." + M->getName().str();
+                        kept = name.size();
+                        Ty = M->getBaseType();
+                    } else {
+                        name += "[]";
+                        if (!C || !C->isZero()) kept = name.size();
+                        // a C array of arrays is one debug type with a subrange per
+                        // dimension: its element type once no dimension follows
+                        if (!GTI.getIndexedType()->isArrayTy()) Ty = pointeeType(Ty);
+                    }
                 }
             }
-            
-            return "";
+            return true;
         }
 
-        void traceStoreValue(StoreInst* SI) {
+        // append to name the fields and elements offset bits into an object of
+        // type T steps into. False if T does not say.
+        bool fieldsAt(const DIType* T, uint64_t offset, string &name) {
+            string path;
+            while (offset > 0) {
+                T = stripTypedefs(T);
+                const DICompositeType* C = dyn_cast_or_null<DICompositeType>(T);
+                if (!C) return false;
+                if (C->getTag() == dwarf::DW_TAG_array_type) {
+                    const DIType* E = stripTypedefs(C->getBaseType());
+                    if (!E || E->getSizeInBits() == 0) return false;
+                    path += "[]";
+                    offset %= E->getSizeInBits();
+                    T = E;
+                    continue;
+                }
+                const DIDerivedType* In = nullptr;
+                for (const DINode* N : C->getElements()) {
+                    const DIDerivedType* M = dyn_cast<DIDerivedType>(N);
+                    if (M && M->getTag() == dwarf::DW_TAG_member && M->getOffsetInBits() <= offset &&
+                        offset < M->getOffsetInBits() + M->getSizeInBits())
+                        In = M;
+                }
+                if (!In) return false;
+                path += "." + In->getName().str();
+                offset -= In->getOffsetInBits();
+                T = In->getBaseType();
+            }
+            name += path;
+            return !path.empty();
+        }
+
+        void traceStoreValue(StoreInst* SI, function_facts &ff) {
             // Guard against null StoreInst
             if (!SI) return;
             
@@ -124,88 +452,165 @@ namespace {
             // Guard against null operands
             if (!PtrOp || !ValOp) return;
             
-            std::string varName = getVariableName(PtrOp);
+            DILocalVariable* Local = nullptr;
+            vector<string> memory;
+            std::string varName = locationName(PtrOp, &Local, false, &memory);
             if (!varName.empty()) {
-                const DebugLoc &DL = SI->getDebugLoc();
-                DILocation* Loc = DL.get();
+                // a local is assigned in the code of the function declaring it
+                DILocation* Loc = Local ? locationIn(SI->getDebugLoc().get(), Local->getScope()->getSubprogram())
+                                        : sourceLocation(*SI);
                 
                 // Guard against missing location info
                 if (!Loc) return;
                 
-                StringRef File = Loc->getFilename();
-                // Guard against empty filename
-                if (File.empty()) return;
-                
-                unsigned Line = DL.getLine();
-                
-                // Guard against file open failures
-                std::ifstream sourceFile(File.str());
-                if (!sourceFile.is_open()) return;
+                unsigned Line = Loc->getLine();
+                sym scope = locationScope(Loc, ff);
+                sym name = ff.names.intern(varName);
+                for (const string &m : memory) ff.memory.push_back(std::make_tuple(name, scope, ff.names.intern(m)));
                 
-                std::string sourceLine;
-                unsigned currentLine = 1;
+                sym vscope = Local ? scope : SYM_GLOBAL;
                 
-                // Read until we find the line we want
-                while (std::getline(sourceFile, sourceLine) && currentLine < Line) {
-                    currentLine++;
+                int v;
+                bool known = find_function_variable(ff, name, vscope, v);
+                // a location is a variable from its first store on, one in a
+                // global shared by every function
+                if (!known && is_location(varName)) {
+                    int base_line = Local ? Local->getLine() : 0;
+                    if (!Local) {
+                        auto m = names.ids.find(StringRef(varName).take_front(location_base_length(varName)));
+                        if (m != names.ids.end() && indexes.global_vars.count(m->second))
+                            base_line = variable_infos.defined_at_line[indexes.global_vars.at(m->second)];
+                    }
+                    v = ff.vars.add(name, vscope, base_line);
+                    ff.var_index.emplace(sym_pair(name, vscope), v);
+                    known = true;
                 }
-                
-                // Guard against not finding the line
-                if (currentLine != Line) {
-                    sourceFile.close();
-                    return;
+                if (known && ValOp->getType()->isPointerTy())
+                    ff.pointers.push_back({name, vscope});
+                // stored to what the variable points to (*p = t), not to
+                // the variable itself
+                const Value* Base = PtrOp->stripInBoundsOffsets();
+                bool through = !isa<AllocaInst>(Base) && !isa<GlobalVariable>(Base);
+                int l = find_line_index_in_variables_per_line(Line);
+                if (known && l != -1) {
+                    ff.gets.add(v, Line, Loc->getColumn(), classifyStoredValue(ValOp), ValOp,
+                                ff.names.intern(Loc->getFilename()), l, scope, through);
                 }
-                
-                // Now it's safe to process the line
-                int v = find_variable_index_in_variable_infos(varName, current_scope);
-                if (v != -1) {
-                    var_map vm = variable_infos[v];
-                    get_list gl;
-                    gl.gets_at_line = Line;
-                    line_map lm = variables_per_line[find_line_index_in_variables_per_line(Line)];
-                    gl.vars = lm;
-                    gl.vars.scope = current_scope;
-                    
-                    if(lm.vars.size() > 1) {
-                        if(find_function_index_in_function_calls_line(Line) != -1) {
-                            gl.type = "func";
-                        } else {
-                            gl.type = "var";
-                        }
-                    } else {
-                        if(find_function_index_in_functions_line(Line) != -1) {
-                            gl.type = "param";
-                        } else {
-                            gl.type = "var";
-                        }
-                    }
-                    
-                    // Guard against invalid source line format
-                    vector<string> temp = split(sourceLine, '=');
-                    if (temp.size() < 2) return;
-                    
-                    gl.code = temp[1];
-                    vm.gets_value_infos.push_back(gl);
-                    variable_infos[v] = vm;
+            }
+        }
+
+        // after mem2reg an assignment is a dbg.value, placed where the store
+        // was but with no line of its own: the variable gets the value on the
+        // line that computes it, and a parameter where the function starts.
+        // Constants carry no input and phis only merge other assignments, so
+        // neither is recorded.
+        void traceDbgValue(Value* V, DILocalVariable* Var, DILocation* Loc, function_facts &ff) {
+            if (!Var || !Loc || !ownVariable(Var, Loc)) return;
+            const DISubprogram* SP = Var->getScope()->getSubprogram();
+            sym name = ff.names.intern(Var->getName());
+            sym scope = locationScope(Loc, ff);
+            if (!ff.var_index.count(sym_pair(name, scope)))
+                ff.var_index.emplace(sym_pair(name, scope), ff.vars.add(name, scope, Var->getLine()));
+            if (isPointerType(Var->getType())) ff.pointers.push_back({name, scope});
+            if (!V || isa<Constant>(V) || isa<PHINode>(V)) return;
+
+            unsigned Line = 0;
+            StringRef File;
+            if (isa<Argument>(V)) {
+                Line = Var->getLine();
+                File = Var->getFilename();
+            } else if (Instruction* I = dyn_cast<Instruction>(V)) {
+                // computed in a function inlined here: the line of that call
+                if (DILocation* At = locationIn(I->getDebugLoc().get(), SP)) {
+                    Line = At->getLine();
+                    File = At->getFilename();
                 }
-                
-                sourceFile.close();
             }
+            if (Line == 0) return;
+
+            int v;
+            bool known = find_function_variable(ff, name, scope, v);
+            int l = find_line_index_in_variables_per_line(Line);
+            if (known && l != -1)
+                ff.gets.add(v, Line, 0, classifyStoredValue(V), V, ff.names.intern(File), l, scope, false);
         }
 
-        vector<string> split(string str, char delimiter) {
-            vector<string> internal;
-            stringstream ss(str); // Turn the string into a stream.
-            string tok;
-            
-            while(getline(ss, tok, delimiter)) {
-                internal.push_back(tok);
+        // classify where a stored value comes from by looking at the IR that
+        // computes it: a call wins over a parameter, which wins over a
+        // variable (load or address), which wins over a constant
+        store_kind classifyStoredValue(const Value* V, int depth = 0) {
+            if (!V) return STORE_VAL;
+            if (const CastInst* CI = dyn_cast<CastInst>(V))
+                return classifyStoredValue(CI->getOperand(0), depth);
+
+            if (isa<CallBase>(V)) return STORE_FUNC;
+            if (isa<Argument>(V)) return STORE_PARAM;
+            if (isa<LoadInst>(V) || isa<GlobalVariable>(V) || isa<AllocaInst>(V)) return STORE_VAR;
+            if (isa<GetElementPtrInst>(V)) return STORE_GEP;
+            if (isa<Constant>(V)) return STORE_VAL;
+
+            // arithmetic, compares, selects, phis: rank the operands
+            store_kind best = STORE_VAL;
+            const Instruction* I = dyn_cast<Instruction>(V);
+            if (!I || depth > 8) return STORE_VAR;
+            for (const Use &U : I->operands()) {
+                store_kind t = classifyStoredValue(U.get(), depth + 1);
+                if (t == STORE_FUNC) return t;
+                if (t == STORE_PARAM || (best == STORE_VAL && t != STORE_VAL)) best = t;
             }
-            
-            return internal;
+            return best;
         }
 
-        std::string getArgValue(Value* Arg, Function* CalledF = nullptr) {
+        // render the right hand side of the assignment get row g came from.
+        // Only used when printing, so the source is read lazily. The store is
+        // located at the assignment operator (or at the declared name for
+        // initializers), so we start there instead of at the first '=' on the
+        // line, which keeps '==', compound assignments and several statements
+        // per line apart.
+        string renderGetCode(int g) {
+            StringRef line;
+            StringRef file = names.str(get_infos.file[g]);
+            if (file.empty() || !sources.get_line(file, get_infos.line[g], line)) return "";
+
+            unsigned col = get_infos.col[g];
+            size_t pos = col > 0 ? std::min<size_t>(col - 1, line.size()) : 0;
+            size_t stmt_end = findExprEnd(line, pos);
+
+            for (size_t i = pos; i < stmt_end; i++) {
+                if (line[i] != '=') continue;
+                if (i + 1 < line.size() && line[i + 1] == '=') { i++; continue; }
+                if (i > 0 && StringRef("=!<>").contains(line[i - 1]) &&
+                    !(i > 1 && line[i - 2] == line[i - 1])) continue;
+                return line.slice(i + 1, findExprEnd(line, i + 1)).trim().str();
+            }
+            // no assignment operator (x++, parameter spills, macros): show the line
+            return line.trim().str();
+        }
+
+        // end of the expression starting at pos: the first ',' or ';' outside
+        // brackets, or the bracket that closes an enclosing expression
+        size_t findExprEnd(StringRef line, size_t pos) {
+            int depth = 0;
+            char quote = 0;
+            for (size_t i = pos; i < line.size(); i++) {
+                char c = line[i];
+                if (quote) {
+                    if (c == '\\') i++;
+                    else if (c == quote) quote = 0;
+                    continue;
+                }
+                if (c == '"' || c == '\'') quote = c;
+                else if (c == '(' || c == '[' || c == '{') depth++;
+                else if (c == ')' || c == ']' || c == '}') {
+                    if (depth == 0) return i;
+                    depth--;
+                }
+                else if ((c == ',' || c == ';') && depth == 0) return i;
+            }
+            return line.size();
+        }
+
+        std::string getArgValue(Value* Arg) {
             // Handle string literals
 
             if (ConstantInt* CI = dyn_cast<ConstantInt>(Arg)) {
@@ -224,754 +629,2226 @@ namespace {
                 }
             }
             
-            // Handle array variables
-            if (GetElementPtrInst* GEP = dyn_cast<GetElementPtrInst>(Arg)) {
-                Value* PtrOp = GEP->getPointerOperand();
-                if (AllocaInst* AI = dyn_cast<AllocaInst>(PtrOp)) {
-                    if (debugVars.count(AI)) {
-                        return debugVars[AI]->getName().str();
-                    }
-                }
+            // the address of an array, a field or an element
+            if (isa<GEPOperator>(Arg)) {
+                std::string loc = locationName(Arg, nullptr, true);
+                if (!loc.empty()) return loc;
             }
             
             // Handle regular variables
             if (LoadInst* LI = dyn_cast<LoadInst>(Arg)) {
-                std::string varName = getVariableName(LI->getPointerOperand());
+                std::string varName = locationName(LI->getPointerOperand());
                 if (!varName.empty()) {
                     return varName;
                 }
             }
             
-            std::string varName = getVariableName(Arg);
-            if (!varName.empty()) {
-                return varName;
+            if (findGlobalVariable(Arg) || findDeclaredVariable(Arg)) {
+                return locationName(Arg);
             }
+
+            // after mem2reg, the variable a dbg.value says it holds
+            SmallVector<DILocalVariable*, 2> vars;
+            describedVariables(Arg, vars);
+            if (!vars.empty()) return vars[0]->getName().str();
             
             return "";
         }
 
-        Function* resolveFunctionPointer(Value* V) {
-            if (!V) return nullptr;
-            
-            // If it's already a function, return it
-            if (Function* F = dyn_cast<Function>(V)) {
-                return F;
+        // the functions a call can run: its callee, or for a call through a
+        // pointer every function the points-to analysis says it may point to
+        void calledFunctions(const CallBase &CB, SmallVectorImpl<Function*> &out) {
+            if (Function* F = dyn_cast<Function>(CB.getCalledOperand()->stripPointerCasts())) {
+                out.push_back(F);
+                return;
             }
-            
-            // Handle bitcast of function to function pointer type
-            if (ConstantExpr* CE = dyn_cast<ConstantExpr>(V)) {
-                if (CE->getOpcode() == Instruction::BitCast) {
-                    return resolveFunctionPointer(CE->getOperand(0));
+            auto it = call_targets.find(&CB);
+            if (it != call_targets.end()) out.append(it->second.begin(), it->second.end());
+        }
+
+        void handleFunctionCall(CallInst* CI, function_facts &ff) {
+            // Skip debug intrinsics
+            if (isa<DbgInfoIntrinsic>(CI)) return;
+
+            SmallVector<Function*, 2> targets;
+            calledFunctions(*CI, targets);
+
+            if (DILocation* Loc = sourceLocation(*CI)) {
+                // a call through a pointer is a call to every function it may run
+                for (Function* F : targets) {
+                    SmallVector<param, 8> args;
+                    int ii = 0;
+                    for (Use &U : CI->args()) {
+                        std::string argValue = getArgValue(U.get());
+                        if (argValue.empty()) {
+                            args.push_back({-1, SYM_UNKNOWN});
+                        } else {
+                            args.push_back({ii, ff.names.intern(argValue)});
+                            ii++;
+                        }
+                    }
+
+                    ff.calls.add(ff.names.intern(F->getName()), locationScope(Loc, ff),
+                                 Loc->getLine(), args);
                 }
             }
-            
-            // Handle address of function
-            if (UnaryOperator* UO = dyn_cast<UnaryOperator>(V)) {
-                if (UO->getOpcode() == UnaryOperator::AddrSpaceCast) {
-                    return resolveFunctionPointer(UO->getOperand(0));
+        }
+
+        points_to_graph points_to;
+        std::unordered_map<const Value*, int> points_to_nodes;     // pointer value or object -> node
+        std::unordered_map<const Function*, int> points_to_returns; // what a function's returned pointer points to
+        vector<pair<const Value*, int>> points_to_objects;         // every object and its node, in the order met
+        std::unordered_map<int, vector<string>> object_names;       // class -> names of its named objects, in the order met
+        std::unordered_map<const CallBase*, vector<Function*>> call_targets; // calls through a pointer -> functions it may run
+        std::unordered_map<int, vector<Function*>> class_functions; // class -> functions using an address in it, with -seminal-demand
+        std::unordered_map<int, vector<const GlobalVariable*>> class_globals; // class -> globals in it, with -seminal-demand
+        StringMap<vector<int>> object_classes;                      // name of an object -> the classes named by it
+
+        static bool isAllocation(const Value* V) {
+            const CallBase* CB = dyn_cast<CallBase>(V);
+            const Function* F = CB ? CB->getCalledFunction() : nullptr;
+            if (!F || !F->isDeclaration()) return false;
+            StringRef name = F->getName();
+            return name == "malloc" || name == "calloc" || name == "realloc" || name == "strdup";
+        }
+
+        // the value a pointer is computed from: steps into fields and
+        // elements and casts keep pointing into the same object
+        static const Value* pointerBase(const Value* V) {
+            for (;;) {
+                if (const GEPOperator* GEP = dyn_cast<GEPOperator>(V)) V = GEP->getPointerOperand();
+                else if (isa<BitCastOperator>(V) || isa<AddrSpaceCastOperator>(V)) V = cast<Operator>(V)->getOperand(0);
+                else return V;
+            }
+        }
+
+        // the points-to node of what the pointer V points to, created on first
+        // use; the address of a variable, a function or allocated memory is
+        // that object. -1 for null and other constants that point nowhere.
+        int pointsToNode(const Value* V) {
+            V = pointerBase(V);
+            auto it = points_to_nodes.find(V);
+            if (it != points_to_nodes.end()) return it->second;
+            bool object = isa<GlobalValue>(V) || isa<AllocaInst>(V) || isAllocation(V);
+            if (!object && isa<Constant>(V)) return -1;
+            int n = points_to.add();
+            points_to_nodes.emplace(V, n);
+            if (object) points_to_objects.push_back({V, n});
+            return n;
+        }
+
+        // the class of what the pointer V points to, once the points-to
+        // analysis is done; -1 if it points to nothing the analysis saw
+        int pointsToClass(const Value* V) const {
+            auto it = points_to_nodes.find(pointerBase(V));
+            return it == points_to_nodes.end() ? -1 : points_to.class_of(it->second);
+        }
+
+        void unify(int a, int b) {
+            if (a != -1 && b != -1) points_to.join(a, b);
+        }
+
+        int contentsOf(int n) { return n == -1 ? -1 : points_to.contents_of(n); }
+
+        int returnNode(const Function* F) {
+            auto it = points_to_returns.find(F);
+            if (it == points_to_returns.end()) it = points_to_returns.emplace(F, points_to.add()).first;
+            return it->second;
+        }
+
+        // a call of CB runs F: its pointer arguments are F's parameters, and
+        // a returned pointer is the call's value
+        void bindCall(const CallBase &CB, const Function &F) {
+            if (F.isDeclaration() || (CB.arg_size() != F.arg_size() && !F.isVarArg())) return;
+            for (unsigned i = 0; i < CB.arg_size() && i < F.arg_size(); i++) {
+                if (CB.getArgOperand(i)->getType()->isPointerTy())
+                    unify(pointsToNode(CB.getArgOperand(i)), pointsToNode(F.getArg(i)));
+            }
+            if (CB.getType()->isPointerTy() && F.getReturnType()->isPointerTy())
+                unify(pointsToNode(&CB), returnNode(&F));
+        }
+
+        // the name of an object: the variable it is, or the allocation call
+        // and the line it is on. A local is qualified by its function, as
+        // locals of the same name in other functions are other objects.
+        // "" for objects with no name in the source.
+        string objectName(const Value* V) {
+            if (const GlobalVariable* GV = dyn_cast<GlobalVariable>(V)) {
+                if (DIGlobalVariable* DGV = findGlobalVariable(GV)) return "&" + DGV->getName().str();
+            } else if (const AllocaInst* AI = dyn_cast<AllocaInst>(V)) {
+                if (DILocalVariable* DV = findDeclaredVariable(V))
+                    return AI->getFunction()->getName().str() + "::&" + DV->getName().str();
+            } else if (isAllocation(V)) {
+                DILocation* Loc = sourceLocation(*cast<Instruction>(V));
+                return cast<CallBase>(V)->getCalledFunction()->getName().str() + "@" + std::to_string(Loc ? Loc->getLine() : 0);
+            }
+            return "";
+        }
+
+        // Steensgaard's analysis over every defined function: a pointer is
+        // unified with what it is copied from, loaded from memory, stored to
+        // memory, passed as or returned as. Calls through pointers are bound to
+        // the functions their pointer may point to, again until no call gets
+        // a new function. Only reads the IR; done before the functions are
+        // walked, which then only look the results up. It reads every
+        // instruction of the module, so the branches are numbered on the way.
+        void buildPointsTo(const vector<Function*> &defined) {
+            vector<const CallBase*> indirect;
+            vector<pair<int, Function*>> addressed;
+            for (Function* F : defined) {
+                std::unordered_set<int> used;
+                for (BasicBlock &BB : *F) {
+                    for (Instruction &I : BB) {
+                        if (isa<BranchInst>(I) || isa<SwitchInst>(I) || isa<SelectInst>(I)) recordBranch(I);
+                        // with -seminal-demand, which memory each function may access.
+                        // Constants (globals, their fields, direct callees) are
+                        // skipped: a function using a global is found by its users.
+                        if (SeminalDemand && !isa<DbgInfoIntrinsic>(I)) {
+                            for (const Use &U : I.operands()) {
+                                if (!U->getType()->isPointerTy() || isa<Constant>(U.get())) continue;
+                                int n = pointsToNode(U.get());
+                                if (n != -1 && used.insert(n).second) addressed.push_back({n, F});
+                            }
+                        }
+                        if (LoadInst* LI = dyn_cast<LoadInst>(&I)) {
+                            if (LI->getType()->isPointerTy())
+                                unify(pointsToNode(LI), contentsOf(pointsToNode(LI->getPointerOperand())));
+                        } else if (StoreInst* SI = dyn_cast<StoreInst>(&I)) {
+                            if (SI->getValueOperand()->getType()->isPointerTy())
+                                unify(contentsOf(pointsToNode(SI->getPointerOperand())), pointsToNode(SI->getValueOperand()));
+                        } else if (PHINode* PN = dyn_cast<PHINode>(&I)) {
+                            if (PN->getType()->isPointerTy()) {
+                                for (Value* In : PN->incoming_values()) unify(pointsToNode(PN), pointsToNode(In));
+                            }
+                        } else if (SelectInst* Sel = dyn_cast<SelectInst>(&I)) {
+                            if (Sel->getType()->isPointerTy()) {
+                                unify(pointsToNode(Sel), pointsToNode(Sel->getTrueValue()));
+                                unify(pointsToNode(Sel), pointsToNode(Sel->getFalseValue()));
+                            }
+                        } else if (ReturnInst* RI = dyn_cast<ReturnInst>(&I)) {
+                            if (RI->getReturnValue() && RI->getReturnValue()->getType()->isPointerTy())
+                                unify(returnNode(F), pointsToNode(RI->getReturnValue()));
+                        } else if (MemTransferInst* MT = dyn_cast<MemTransferInst>(&I)) {
+                            unify(contentsOf(pointsToNode(MT->getRawDest())), contentsOf(pointsToNode(MT->getRawSource())));
+                        } else if (CallBase* CB = dyn_cast<CallBase>(&I)) {
+                            if (isa<DbgInfoIntrinsic>(CB)) continue;
+                            Function* Callee = dyn_cast<Function>(CB->getCalledOperand()->stripPointerCasts());
+                            if (!Callee) {
+                                if (!CB->isInlineAsm()) indirect.push_back(CB);
+                            }
+                            else if (isAllocation(CB)) {
+                                int n = pointsToNode(CB);
+                                if (Callee->getName() == "realloc") unify(n, pointsToNode(CB->getArgOperand(0)));
+                            } else {
+                                bindCall(*CB, *Callee);
+                            }
+                        }
+                        // every pointer gets a node, so every address can be looked up later
+                        if (I.getType()->isPointerTy()) pointsToNode(&I);
+                    }
+                }
+                for (Argument &A : F->args()) {
+                    if (A.getType()->isPointerTy()) pointsToNode(&A);
                 }
             }
-            
-            // Handle loading from a pointer
+
+            std::set<pair<const CallBase*, const Function*>> bound;
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (const CallBase* CB : indirect) {
+                    int c = pointsToNode(CB->getCalledOperand());
+                    for (auto &obj : points_to_objects) {
+                        const Function* F = dyn_cast<Function>(obj.first);
+                        if (!F || c == -1 || points_to.find(obj.second) != points_to.find(c)) continue;
+                        if (!bound.insert({CB, F}).second) continue;
+                        bindCall(*CB, *F);
+                        changed = true;
+                    }
+                }
+            }
+            points_to.flatten();
+            for (auto &nf : addressed) {
+                vector<Function*> &fns = class_functions[points_to.class_of(nf.first)];
+                if (fns.empty() || fns.back() != nf.second) fns.push_back(nf.second);
+            }
+            if (SeminalDemand) {
+                for (auto &obj : points_to_objects) {
+                    if (const GlobalVariable* GV = dyn_cast<GlobalVariable>(obj.first))
+                        class_globals[points_to.class_of(obj.second)].push_back(GV);
+                }
+            }
+
+            for (auto &cf : bound) {
+                if (!cf.second->isDeclaration()) call_targets[cf.first].push_back(const_cast<Function*>(cf.second));
+            }
+            // the targets of a call in module order, not pointer order
+            for (auto &ct : call_targets) {
+                std::sort(ct.second.begin(), ct.second.end(), [&](Function* a, Function* b) {
+                    return function_order.at(a) < function_order.at(b);
+                });
+            }
+            for (auto &obj : points_to_objects) {
+                string name = objectName(obj.first);
+                if (name.empty()) continue;
+                int c = points_to.class_of(obj.second);
+                object_names[c].push_back(name);
+                object_classes[name].push_back(c);
+            }
+        }
+
+        std::unordered_map<const Function*, size_t> function_order;   // defined function -> position in the module
+
+        // the memory objects the location name, at the address Ptr, may be,
+        // each followed by the path name takes from the last pointer it goes
+        // through: the object itself for an address in a variable, every
+        // object of its class for one reached through a pointer. Two variables
+        // in one class are still never the same memory. An index of the object
+        // itself is the object, as an array and its elements are one for the
+        // analysis.
+        vector<string> memoryNames(const Value* Ptr, StringRef path) {
+            if (path.startswith("[]")) path = path.drop_front(2);
+            const Value* B = pointerBase(Ptr);
+            if (isa<GlobalValue>(B) || isa<AllocaInst>(B) || isAllocation(B)) {
+                string name = objectName(B);
+                if (name.empty()) return {};
+                return {name + path.str()};
+            }
+            int c = pointsToClass(Ptr);
+            auto it = c == -1 ? object_names.end() : object_names.find(c);
+            if (it == object_names.end()) return {};
+            vector<string> out;
+            for (const string &name : it->second) out.push_back(name + path.str());
+            return out;
+        }
+
+        // functions that were inlined into F and removed: their code is
+        // still walked as part of F's, so they are recorded with it
+        void recordRemovedFunctions(Function &F, function_facts &ff) {
+            const function_debug_vars &dv = getDebugVars(&F);
+            for (const DISubprogram *SP : dv.removed) {
+                std::map<unsigned, sym> params;
+                for (const DINode *N : SP->getRetainedNodes()) {
+                    const DILocalVariable *Var = dyn_cast<DILocalVariable>(N);
+                    if (Var && Var->getArg()) params.emplace(Var->getArg() - 1, ff.names.intern(Var->getName()));
+                }
+                for (const inlined_arg &ia : dv.inlined_args) {
+                    if (ia.param->getScope()->getSubprogram() == SP)
+                        params.emplace(ia.param->getArg() - 1, ff.names.intern(ia.param->getName()));
+                }
+                SmallVector<param, 8> args;
+                unsigned count = params.empty() ? 0 : params.rbegin()->first + 1;
+                for (unsigned pos = 0; pos < count; pos++) {
+                    auto it = params.find(pos);
+                    args.push_back({(int)pos, it != params.end() ? it->second : ff.names.intern("arg" + std::to_string(pos))});
+                }
+                ff.functions.add(SP->getLine(), subprogramScope(SP, ff), args);
+            }
+        }
+
+        // a call that was inlined into F is gone, but the values its
+        // parameters were given are still described: record it as a call on
+        // the line it was made from, so the parameters get their values there.
+        // Calls made by code that is itself part of another inlined call are
+        // left to that function's own copy.
+        void recordInlinedCalls(Function &F, function_facts &ff) {
+            const function_debug_vars &dv = getDebugVars(&F);
+            vector<const DILocation*> order;
+            std::unordered_map<const DILocation*, SmallVector<const inlined_arg*, 4>> by_call;
+            for (const inlined_arg &ia : dv.inlined_args) {
+                auto &args = by_call[ia.call];
+                if (args.empty()) order.push_back(ia.call);
+                args.push_back(&ia);
+            }
+
+            for (const DILocation *Call : order) {
+                DILocation *At = sourceLocation(const_cast<DILocation*>(Call));
+                if (At != Call) continue;
+                const DISubprogram *SP = by_call[Call][0]->param->getScope()->getSubprogram();
+                sym callee = subprogramScope(SP, ff);
+                Function *CalleeF = F.getParent()->getFunction(ff.names.str(callee));
+                unsigned count = CalleeF ? CalleeF->arg_size() : 0;
+                for (const inlined_arg *ia : by_call[Call]) count = std::max(count, ia->param->getArg());
+
+                vector<Value*> values(count, nullptr);
+                for (const inlined_arg *ia : by_call[Call]) {
+                    if (!values[ia->param->getArg() - 1]) values[ia->param->getArg() - 1] = ia->value;
+                }
+                SmallVector<param, 8> args;
+                int ii = 0;
+                for (Value *V : values) {
+                    std::string argValue = V ? getArgValue(V) : "";
+                    if (argValue.empty()) {
+                        args.push_back({-1, SYM_UNKNOWN});
+                    } else {
+                        args.push_back({ii, ff.names.intern(argValue)});
+                        ii++;
+                    }
+                }
+                ff.calls.add(callee, locationScope(Call, ff), Call->getLine(), args);
+            }
+        }
+
+        // whether every use of I is as an argument of a call to functions
+        // defined in the module, and the (function, position) of each
+        bool passedOnlyToDefinedFunctions(const Instruction &I, SmallVectorImpl<pair<Function*, unsigned>> &passed) {
+            if (I.use_empty()) return false;
+            for (const Use &U : I.uses()) {
+                const CallInst *CI = dyn_cast<CallInst>(U.getUser());
+                if (!CI || !CI->isArgOperand(&U)) return false;
+                SmallVector<Function*, 2> targets;
+                calledFunctions(*CI, targets);
+                if (targets.empty()) return false;
+                for (Function *F : targets) {
+                    if (F->isDeclaration()) return false;
+                    passed.push_back({F, CI->getArgOperandNo(&U)});
+                }
+            }
+            return true;
+        }
+
+        // the lines the value a function returns is computed on. Without
+        // optimization a function with several returns stores each value to a
+        // slot with no debug variable and loads it at the end, so those are the
+        // stores' lines; otherwise it is the line of the returned instruction.
+        // Which return runs is decided by the function's branches, so the
+        // lines of their conditions count as well.
+        void recordReturnLines(Instruction* I, function_facts &ff) {
+            if (I->getFunction()->getReturnType()->isVoidTy()) return;
+            // inlined code counts on the line of its call
+            DISubprogram* SP = I->getFunction()->getSubprogram();
+            if (isa<BranchInst>(I) || isa<SwitchInst>(I)) {
+                Value* Cond = isa<BranchInst>(I) ? cast<BranchInst>(I)->getCondition() : cast<SwitchInst>(I)->getCondition();
+                Instruction* CI = dyn_cast<Instruction>(Cond);
+                if (DILocation* Loc = CI ? locationIn(CI->getDebugLoc().get(), SP) : nullptr) ff.return_lines.push_back(Loc->getLine());
+                return;
+            }
+            ReturnInst* RI = dyn_cast<ReturnInst>(I);
+            if (!RI) return;
+            Value* V = RI->getReturnValue();
+            if (!V) return;
             if (LoadInst* LI = dyn_cast<LoadInst>(V)) {
-                Value* PtrOp = LI->getPointerOperand();
-                
-                // Look through all users of the pointer to find where it's stored
-                for (User* U : PtrOp->users()) {
-                    if (StoreInst* SI = dyn_cast<StoreInst>(U)) {
-                        if (SI->getPointerOperand() == PtrOp) {
-                            Value* StoredValue = SI->getValueOperand();
-                            if (Function* F = resolveFunctionPointer(StoredValue)) {
-                                return F;
+                Value* Slot = LI->getPointerOperand();
+                if (isa<AllocaInst>(Slot) && !findDeclaredVariable(Slot)) {
+                    for (User* U : Slot->users()) {
+                        StoreInst* SI = dyn_cast<StoreInst>(U);
+                        if (SI && SI->getPointerOperand() == Slot && SI->getDebugLoc())
+                            ff.return_lines.push_back(SI->getDebugLoc().getLine());
+                    }
+                    return;
+                }
+            }
+            // after mem2reg the returns are merged by a phi instead
+            SmallVector<Value*, 4> work = {V};
+            SmallPtrSet<Value*, 8> seen;
+            while (!work.empty()) {
+                Instruction* VI = dyn_cast<Instruction>(work.pop_back_val());
+                if (!VI || !seen.insert(VI).second) continue;
+                if (PHINode* PN = dyn_cast<PHINode>(VI)) {
+                    for (Value* In : PN->incoming_values()) work.push_back(In);
+                } else if (DILocation* Loc = locationIn(VI->getDebugLoc().get(), SP)) {
+                    ff.return_lines.push_back(Loc->getLine());
+                }
+            }
+        }
+
+        // the variable declared by the function itself whose storage V points
+        // into, looking through element and field addresses and casts; null if
+        // there is none
+        AllocaInst* variableStorage(Value* V) {
+            for (;;) {
+                if (GEPOperator* GEP = dyn_cast<GEPOperator>(V)) V = GEP->getPointerOperand();
+                else if (BitCastOperator* BC = dyn_cast<BitCastOperator>(V)) V = BC->getOperand(0);
+                else break;
+            }
+            AllocaInst* AI = dyn_cast<AllocaInst>(V);
+            DILocalVariable* Var = AI ? findDeclaredVariable(AI) : nullptr;
+            return Var && Var->getScope()->getSubprogram() == AI->getFunction()->getSubprogram() ? AI : nullptr;
+        }
+
+        // reaching definitions of F's declared variables, as (variable, line it
+        // is read on, line of a definition that reaches it) facts. A store to
+        // the variable replaces its other definitions; a store into one of its
+        // elements or fields, or a call it is passed to by address, may not.
+        // Every variable also has a definition on line 0, the value F was
+        // entered with. Blocks are visited in reverse post order until the
+        // definitions leaving them stop changing.
+        void collectReachingDefs(Function &F, function_facts &ff) {
+            typedef struct {
+                int var;
+                bool replaces;
+                unsigned line;
+            } definition;
+            vector<AllocaInst*> vars;
+            std::unordered_map<const AllocaInst*, int> var_index;
+            vector<definition> defs;
+            vector<int> entry_defs;
+            std::unordered_map<const Instruction*, SmallVector<int, 2>> defs_at;
+            auto var_of = [&](AllocaInst* AI) {
+                auto it = var_index.find(AI);
+                if (it != var_index.end()) return it->second;
+                int v = vars.size();
+                vars.push_back(AI);
+                var_index.emplace(AI, v);
+                entry_defs.push_back(defs.size());
+                defs.push_back({v, true, 0});
+                return v;
+            };
+            auto add_def = [&](const Instruction &I, int v, bool replaces, unsigned line) {
+                defs_at[&I].push_back(defs.size());
+                defs.push_back({v, replaces, line});
+            };
+            auto line_of = [&](const Instruction &I) {
+                DILocation* Loc = sourceLocation(I);
+                return Loc ? Loc->getLine() : 0u;
+            };
+            // the variables I reads: what a load reads from, and what a call is passed by address
+            auto reads = [&](Instruction &I, SmallVectorImpl<int> &out) {
+                if (LoadInst* LI = dyn_cast<LoadInst>(&I)) {
+                    if (AllocaInst* AI = variableStorage(LI->getPointerOperand())) out.push_back(var_of(AI));
+                } else if (CallInst* CI = dyn_cast<CallInst>(&I)) {
+                    if (isa<DbgInfoIntrinsic>(CI)) return;
+                    for (Use &U : CI->args()) {
+                        if (!U->getType()->isPointerTy()) continue;
+                        if (AllocaInst* AI = variableStorage(U.get())) out.push_back(var_of(AI));
+                    }
+                }
+            };
+
+            for (BasicBlock &BB : F) {
+                for (Instruction &I : BB) {
+                    SmallVector<int, 4> read;
+                    reads(I, read);
+                    if (StoreInst* SI = dyn_cast<StoreInst>(&I)) {
+                        if (AllocaInst* AI = variableStorage(SI->getPointerOperand()))
+                            add_def(I, var_of(AI), SI->getPointerOperand() == AI, line_of(I));
+                    } else if (isa<CallInst>(I)) {
+                        for (int v : read) add_def(I, v, false, line_of(I));
+                    }
+                }
+            }
+            if (vars.empty()) return;
+
+            size_t D = defs.size();
+            vector<BitVector> var_defs(vars.size(), BitVector(D));
+            BitVector entry(D);
+            for (size_t d = 0; d < D; d++) var_defs[defs[d].var].set(d);
+            for (int d : entry_defs) entry.set(d);
+            auto apply = [&](const Instruction &I, BitVector &live) {
+                auto it = defs_at.find(&I);
+                if (it == defs_at.end()) return;
+                for (int d : it->second) {
+                    if (defs[d].replaces) live.reset(var_defs[defs[d].var]);
+                    live.set(d);
+                }
+            };
+
+            ReversePostOrderTraversal<Function*> order(&F);
+            std::unordered_map<const BasicBlock*, BitVector> out;
+            auto live_in = [&](BasicBlock* BB) {
+                BitVector live = BB == &F.getEntryBlock() ? entry : BitVector(D);
+                for (BasicBlock* P : predecessors(BB)) {
+                    auto o = out.find(P);
+                    if (o != out.end()) live |= o->second;
+                }
+                return live;
+            };
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (BasicBlock* BB : order) {
+                    BitVector live = live_in(BB);
+                    for (Instruction &I : *BB) apply(I, live);
+                    BitVector &o = out[BB];
+                    if (o.size() != D || o != live) {
+                        o = std::move(live);
+                        changed = true;
+                    }
+                }
+            }
+
+            std::set<std::tuple<sym, unsigned, unsigned>> facts;
+            auto name_of = [&](int v) { return ff.names.intern(findDeclaredVariable(vars[v])->getName()); };
+            auto add_facts = [&](int v, unsigned line, const BitVector &reaching) {
+                for (unsigned d : reaching.set_bits())
+                    facts.insert(std::make_tuple(name_of(v), line, defs[d].line));
+            };
+            // what each load read, so a call spread over several lines also
+            // reads its arguments on the line of the call
+            std::unordered_map<const Instruction*, pair<int, BitVector>> loaded;
+            for (BasicBlock* BB : order) {
+                BitVector live = live_in(BB);
+                for (Instruction &I : *BB) {
+                    unsigned line = line_of(I);
+                    if (line != 0) {
+                        SmallVector<int, 4> read;
+                        reads(I, read);
+                        for (int v : read) {
+                            BitVector reaching = live;
+                            reaching &= var_defs[v];
+                            add_facts(v, line, reaching);
+                            if (isa<LoadInst>(I)) loaded.emplace(&I, make_pair(v, reaching));
+                        }
+                        if (CallInst* CI = dyn_cast<CallInst>(&I)) {
+                            for (Use &U : CI->args()) {
+                                auto it = loaded.find(dyn_cast<Instruction>(U.get()));
+                                if (it != loaded.end()) add_facts(it->second.first, line, it->second.second);
                             }
                         }
                     }
+                    apply(I, live);
+                    // a variable assigned on a line has that value there too
+                    auto it = defs_at.find(&I);
+                    if (line != 0 && it != defs_at.end()) {
+                        for (int d : it->second)
+                            facts.insert(std::make_tuple(name_of(defs[d].var), line, line));
+                    }
                 }
             }
-            
-            return nullptr;
+            ff.reaching.assign(facts.begin(), facts.end());
+        }
+
+        void processInstruction(Instruction* I, function_facts &ff) {
+#if LLVM_VERSION_MAJOR >= 19
+            // debug records are attached to the instruction that follows them
+            for (DbgVariableRecord &DVR : filterDbgVars(I->getDbgRecordRange())) {
+                if (DVR.isDbgDeclare())
+                    printDbgValueInfo(DVR.getAddress(), DVR.getVariable(), DVR.getDebugLoc().get(), ff);
+                else if (DVR.isDbgValue())
+                    traceDbgValue(DVR.getValue(), DVR.getVariable(), DVR.getDebugLoc().get(), ff);
+            }
+#endif
+            if (DbgDeclareInst* DDI = dyn_cast<DbgDeclareInst>(I)) {
+                printDbgValueInfo(DDI->getAddress(), DDI->getVariable(), DDI->getDebugLoc().get(), ff);
+            }
+            else if (DbgValueInst* DVI = dyn_cast<DbgValueInst>(I)) {
+                traceDbgValue(DVI->getValue(), DVI->getVariable(), DVI->getDebugLoc().get(), ff);
+            }
+            else if (StoreInst* SI = dyn_cast<StoreInst>(I)) {
+                traceStoreValue(SI, ff);
+            }
+            else if (CallInst* CI = dyn_cast<CallInst>(I)) {
+                handleFunctionCall(CI, ff);
+            }
+            else if (isa<ReturnInst>(I) || isa<SwitchInst>(I) ||
+                     (isa<BranchInst>(I) && cast<BranchInst>(I)->isConditional())) {
+                recordReturnLines(I, ff);
+            }
+        }
+
+        std::vector<unsigned int> targetLines = {11, 12, 13}; // Example line numbers
+        std::map<unsigned int, std::set<sym>> lineToVars;
+
+        void trackGlobalVariables(Module &M) {
+            for (GlobalVariable &GV : M.globals()) {
+                if (DIGlobalVariableExpression* DIGVE = dyn_cast_or_null<DIGlobalVariableExpression>(
+                        GV.getMetadata(LLVMContext::MD_dbg))) {
+                    DIGlobalVariable *DGV = DIGVE->getVariable();
+                    global_debug_vars[&GV] = DGV;
+                    globals_by_name.try_emplace(DGV->getName(), &GV);
+                    unsigned line = DGV->getLine();
+                    lineToVars[line].insert(names.intern(DGV->getName()));
+                }
+            }
+        }
+
+        std::unordered_map<sym, loop_interval_index> loop_intervals;  // per function
+
+        // whether line is in a loop of the function scope names
+        bool line_in_loop(sym scope, unsigned line) const {
+            auto it = loop_intervals.find(scope);
+            return it != loop_intervals.end() && it->second.in_loop(line);
+        }
+
+        // record the source line range and depth of every loop in F. Block
+        // ranges go to their innermost loop, then each loop's range is folded
+        // into its parent, so every block is looked at once.
+        void collectLoopIntervals(Function &F, LoopInfo &LI, function_facts &ff) {
+            std::unordered_map<const Loop*, pair<unsigned, unsigned>> range;
+            for (BasicBlock &BB : F) {
+                Loop* L = LI.getLoopFor(&BB);
+                if (!L) continue;
+                for (Instruction &I : BB) {
+                    DILocation* Loc = sourceLocation(I);
+                    if (!Loc || Loc->getLine() == 0) continue;
+                    unsigned line = Loc->getLine();
+                    auto it = range.emplace(L, make_pair(line, line)).first;
+                    it->second.first = std::min(it->second.first, line);
+                    it->second.second = std::max(it->second.second, line);
+                }
+            }
+
+            SmallVector<Loop*, 8> loops = LI.getLoopsInPreorder();
+            for (auto it = loops.rbegin(); it != loops.rend(); ++it) {
+                Loop* L = *it;
+                auto r = range.find(L);
+                if (r == range.end()) continue;
+                if (Loop* P = L->getParentLoop()) {
+                    auto pr = range.emplace(P, r->second).first;
+                    pr->second.first = std::min(pr->second.first, r->second.first);
+                    pr->second.second = std::max(pr->second.second, r->second.second);
+                }
+                ff.loops.push_back({r->second.first, r->second.second, L->getLoopDepth()});
+            }
+        }
+
+        // scanf and fscanf store what they read through their address
+        // arguments: those are written by the call, not read
+        static bool writesThroughArgs(const Function* F) {
+            if (!F) return false;
+            StringRef N = F->getName();
+            return N == "scanf" || N == "__isoc99_scanf" || N == "fscanf" || N == "__isoc99_fscanf";
+        }
+
+        // whether every use of the pointer V reads or writes through it, or
+        // steps into what it points at
+        bool onlyAddressed(const Value &V) {
+            for (const User *U : V.users()) {
+                if (isa<DbgInfoIntrinsic>(U) || isa<LoadInst>(U)) continue;
+                if (const GEPOperator *GEP = dyn_cast<GEPOperator>(U)) {
+                    if (GEP->getPointerOperand() == &V) continue;
+                } else if (const StoreInst *SI = dyn_cast<StoreInst>(U)) {
+                    if (SI->getValueOperand() != &V) continue;
+                } else if (isa<BitCastOperator>(U) && onlyAddressed(*U)) {
+                    continue;
+                }
+                return false;
+            }
+            return !V.use_empty();
+        }
+
+        void getVariableNamesAtLine(const Instruction &I, function_facts &ff) {
+#if LLVM_VERSION_MAJOR >= 19
+            // debug records are no longer instructions; they sit on the next one
+            for (const DbgVariableRecord &DVR : filterDbgVars(I.getDbgRecordRange())) {
+                if (DVR.isDbgDeclare() && DVR.getDebugLoc() && DVR.getVariable() && ownVariable(DVR.getVariable(), DVR.getDebugLoc().get()))
+                    ff.line_vars.push_back({DVR.getDebugLoc().getLine(), ff.names.intern(DVR.getVariable()->getName())});
+            }
+#endif
+            // a dbg.value has no line of its own; its variable is read where
+            // the value it describes is used
+            if (isa<DbgValueInst>(I)) return;
+            DILocation* Loc = sourceLocation(I);
+            if (!Loc) return;
+
+            unsigned int currentLine = Loc->getLine();
+            ff.lines.push_back(currentLine);
+            auto addVar = [&](StringRef name) {
+                ff.line_vars.push_back({currentLine, ff.names.intern(name)});
+            };
+            // a local is read on the line of its own function's code, which
+            // for code inlined into that function is the line of the call
+            auto addLocal = [&](const DILocalVariable *Var) {
+                if (unsigned line = lineIn(I, Var)) ff.line_vars.push_back({line, ff.names.intern(Var->getName())});
+            };
+            // what the address read or passed on may be the same memory as;
+            // a local's in the scope of its own function's code. The walk
+            // has no scope of its own yet, so it is the function's name.
+            auto addMemory = [&](StringRef loc, ArrayRef<string> memory, const DILocalVariable *Local) {
+                if (memory.empty()) return;
+                DILocation *At = Local ? locationIn(I.getDebugLoc().get(), Local->getScope()->getSubprogram()) : Loc;
+                if (!At) return;
+                sym scope = At->getInlinedAt() ? subprogramScope(At->getScope()->getSubprogram(), ff)
+                                               : ff.names.intern(I.getFunction()->getName());
+                for (const string &m : memory) ff.memory.push_back(std::make_tuple(ff.names.intern(loc), scope, ff.names.intern(m)));
+            };
+
+            // Check for dbg.declare directly
+            if (const DbgVariableIntrinsic *DVI = dyn_cast<DbgVariableIntrinsic>(&I)) {
+                if (DILocalVariable *DIVar = DVI->getVariable()) {
+                    if (!ownVariable(DIVar, DVI->getDebugLoc().get())) return;
+                    addVar(DIVar->getName());
+                }
+            }
+
+            // Check if this is a load or store instruction
+            const Value *Ptr = nullptr;
+            if (const LoadInst *LI = dyn_cast<LoadInst>(&I))
+                Ptr = LI->getPointerOperand();
+            else if (const StoreInst *SI = dyn_cast<StoreInst>(&I))
+                Ptr = SI->getPointerOperand();
+
+            bool only_passed = false;
+            // a pointer loaded only to read or write through it is not read
+            // itself; the location it leads to is, where that happens
+            bool through = Ptr && isa<LoadInst>(I) && I.getType()->isPointerTy() && onlyAddressed(I);
+            if (Ptr && !through) {
+                SmallVector<pair<string, unsigned>, 2> found;
+                DILocalVariable *Local = nullptr;
+                vector<string> memory;
+                string loc = locationName(Ptr, &Local, false, &memory);
+                if (!loc.empty()) {
+                    // a local is read on the line of its own function's code
+                    unsigned line = Local ? lineIn(I, Local) : currentLine;
+                    if (line) found.push_back({loc, line});
+                    addMemory(loc, memory, Local);
+                }
+
+                // a value loaded only to be passed to defined functions is kept
+                // aside until their summaries say whether it matters. Pointers
+                // always count: the function can write through them.
+                SmallVector<pair<Function*, unsigned>, 2> passed;
+                only_passed = !found.empty() && isa<LoadInst>(I) && !I.getType()->isPointerTy() &&
+                              passedOnlyToDefinedFunctions(I, passed);
+                for (auto &fv : found) {
+                    if (!only_passed) {
+                        ff.line_vars.push_back({fv.second, ff.names.intern(fv.first)});
+                        continue;
+                    }
+                    for (auto &pa : passed)
+                        ff.arg_uses.push_back({fv.second, ff.names.intern(fv.first), ff.names.intern(pa.first->getName()), (int)pa.second});
+                }
+            }
+
+            // Add variables at their declaration points
+            for (const Use &U : I.operands()) {
+                // an address computed into a variable is not a read of it
+                if (isa<GetElementPtrInst>(I) && U.getOperandNo() == 0) continue;
+                if (const AllocaInst *AI = dyn_cast_or_null<AllocaInst>(U.get())) {
+                    if (DILocalVariable *DIVar = findDeclaredVariable(AI)) {
+                        // Get the line number from the debug location of the alloca instruction
+                        if (const DebugLoc &AllocaLoc = AI->getDebugLoc()) {
+                            ff.line_vars.push_back({AllocaLoc.getLine(), ff.names.intern(DIVar->getName())});
+                        }
+                        if (!((only_passed || through) && AI == Ptr))
+                            addLocal(DIVar);
+                    }
+                }
+            }
+
+            // after mem2reg a variable is read where a value it holds is an
+            // operand; as with loads, a value passed by value to defined
+            // functions waits for their summaries. Phis only merge values.
+            if (isa<PHINode>(I) || isa<DbgInfoIntrinsic>(I)) return;
+            const CallInst *CI = dyn_cast<CallInst>(&I);
+            SmallVector<Function*, 2> callees;
+            bool writes_args = CI && writesThroughArgs(CI->getCalledFunction());
+            if (CI) {
+                calledFunctions(*CI, callees);
+                if (llvm::any_of(callees, [](Function *F) { return F->isDeclaration(); })) callees.clear();
+            }
+            for (const Use &U : I.operands()) {
+                // addresses: what is read or written through them is recorded
+                // above, and one passed on is the location it points into
+                if ((isa<GetElementPtrInst>(I) || isa<LoadInst>(I) || isa<StoreInst>(I)) && U.getOperandNo() == (isa<StoreInst>(I) ? 1 : 0)) continue;
+                if (isa<GEPOperator>(U.get())) {
+                    // like the address a store writes to
+                    if (writes_args && CI->isArgOperand(&U)) continue;
+                    DILocalVariable *Local = nullptr;
+                    vector<string> memory;
+                    string loc = locationName(U.get(), &Local, true, &memory);
+                    unsigned line = Local ? lineIn(I, Local) : currentLine;
+                    if (!loc.empty() && line) {
+                        ff.line_vars.push_back({line, ff.names.intern(loc)});
+                        addMemory(loc, memory, Local);
+                    }
+                    continue;
+                }
+                SmallVector<DILocalVariable*, 2> vars;
+                describedVariables(U.get(), vars);
+                bool passed = !callees.empty() && CI->isArgOperand(&U) && !U->getType()->isPointerTy();
+                for (DILocalVariable *Var : vars) {
+                    if (!passed) addLocal(Var);
+                    else if (unsigned line = lineIn(I, Var)) {
+                        for (Function *Callee : callees)
+                            ff.arg_uses.push_back({line, ff.names.intern(Var->getName()),
+                                                   ff.names.intern(Callee->getName()), (int)CI->getArgOperandNo(&U)});
+                    }
+                }
+            }
+        }
+
+        vector<branch_site> branch_sites;   // every branch of the module, in module order
+
+        // number a conditional branch, switch or select with source
+        // location, once for every place it can go; a select can go two ways.
+        void recordBranch(const Instruction &I) {
+            const BranchInst* BI = dyn_cast<BranchInst>(&I);
+            if (BI && !BI->isConditional()) return;
+            DILocation* Loc = sourceLocation(I);
+            if (!Loc || Loc->getLine() == 0) return;
+            unsigned line = Loc->getLine();
+            sym file = names.intern(Loc->getFilename());
+            unsigned ways = isa<SelectInst>(I) ? 2 : I.getNumSuccessors();
+            for (unsigned w = 0; w < ways; w++) branch_sites.push_back({file, line});
+        }
+
+        // the files and lines listed in -seminal-branch-info, one branch per
+        // line as "<id>: <file>, <line>, <target>"; its ids are not used. False
+        // if no file was given; a file that cannot be read lists nothing.
+        bool readBranchFilter(std::map<unsigned, vector<string>> &lines) {
+            if (SeminalBranchInfo.empty()) return false;
+            auto buf = MemoryBuffer::getFile(SeminalBranchInfo, /*IsText=*/true);
+            if (!buf) {
+                errs() << "Error: Could not open " << SeminalBranchInfo << "\n";
+                return true;
+            }
+            SmallVector<StringRef, 64> rows;
+            (*buf)->getBuffer().split(rows, '\n', -1, false);
+            for (StringRef row : rows) {
+                SmallVector<StringRef, 4> fields;
+                row.split(fields, ',');
+                unsigned line;
+                if (fields.size() >= 2 && !fields[1].trim().getAsInteger(10, line))
+                    lines[line].push_back(fields[0].split(':').second.trim().str());
+            }
+            return true;
+        }
+
+        // whether the filter lists line of file. A file may be listed by a
+        // shorter path than the one it was compiled from, e.g. test0.c for
+        // /root/repo/test0.c
+        static bool listed(const std::map<unsigned, vector<string>> &wanted, StringRef file, unsigned line) {
+            auto w = wanted.find(line);
+            if (w == wanted.end()) return false;
+            for (StringRef f : w->second) {
+                if (file == f || (file.endswith(f) && file.drop_back(f.size()).endswith("/"))) return true;
+            }
+            return false;
+        }
+
+        // the branch lines to analyze and the id of the first branch on each,
+        // in the order of their ids: every line with a branch, or with a
+        // -seminal-branch-info file only the lines it lists in their file
+        vector<pair<int, string>> branchLines() {
+            std::map<unsigned, vector<string>> wanted;
+            bool filtered = readBranchFilter(wanted);
+            std::set<unsigned> seen;
+            vector<pair<int, string>> lines;
+            for (size_t i = 0; i < branch_sites.size(); i++) {
+                unsigned line = branch_sites[i].line;
+                if ((filtered && !listed(wanted, names.str(branch_sites[i].file), line)) || !seen.insert(line).second) continue;
+                lines.push_back({(int)line, "br_" + std::to_string(i + 1)});
+            }
+            return lines;
+        }
+
+        // add a variable to variable_infos and index it by (name, scope)
+        void add_variable_info(sym name, sym scope, int line) {
+            int idx = variable_infos.add(name, scope, line);
+            if (scope == SYM_GLOBAL)
+                indexes.global_vars.emplace(name, idx);
+            indexes.scoped_vars.emplace(sym_pair(name, scope), idx);
+        }
+
+        std::unordered_set<sym> removed_functions;
+
+        // add what one walk over a function found to the module. Its names are
+        // interned in the order the walk met them, so merging functions in
+        // module order gives every name the id a serial walk would have.
+        void merge_function_facts(const function_facts &ff) {
+            vector<sym> to_module(ff.names.strings.size());
+            for (size_t i = 0; i < ff.names.strings.size(); i++)
+                to_module[i] = names.intern(ff.names.strings[i]);
+            auto map_args = [&](ArrayRef<param> args) {
+                SmallVector<param, 8> out;
+                for (const param &pa : args) out.push_back({pa.id, to_module[pa.name]});
+                return out;
+            };
+
+            for (const loop_interval &l : ff.loops)
+                loop_intervals[to_module[ff.scope]].add(l.first_line, l.last_line, l.depth);
+            for (unsigned line : ff.lines)
+                lineToVars[line];
+            for (auto &lv : ff.line_vars)
+                lineToVars[lv.first].insert(to_module[lv.second]);
+            for (auto &au : ff.arg_uses)
+                arg_uses.push_back({au.line, to_module[au.var], to_module[au.callee], au.pos});
+
+            // facts of one variable come from one function, already sorted
+            for (auto &rd : ff.reaching) {
+                indexes.reaching_defs[sym_pair(to_module[std::get<0>(rd)], to_module[ff.scope])]
+                    .push_back({std::get<1>(rd), std::get<2>(rd)});
+            }
+
+            for (int f = 0; f < ff.functions.size(); f++) {
+                // a removed function inlined into several others is found by each
+                if (f > 0 && !removed_functions.insert(to_module[ff.functions.name[f]]).second) continue;
+                functions.add(ff.functions.line_num[f], to_module[ff.functions.name[f]], map_args(ff.functions.args_of(f)));
+                // its returns are part of the code it was inlined into
+                summaries.push_back({f == 0 ? ff.return_lines : vector<unsigned>(), {}, false});
+            }
+
+            // a location in a global is one variable, whichever function
+            // stored to it first
+            vector<int> var_row(ff.vars.size());
+            for (int v = 0; v < ff.vars.size(); v++) {
+                sym name = to_module[ff.vars.name[v]], scope = to_module[ff.vars.scope[v]];
+                auto g = scope == SYM_GLOBAL ? indexes.global_vars.find(name) : indexes.global_vars.end();
+                if (g != indexes.global_vars.end()) {
+                    var_row[v] = g->second;
+                    continue;
+                }
+                var_row[v] = variable_infos.size();
+                add_variable_info(name, scope, ff.vars.defined_at_line[v]);
+            }
+            for (auto &pv : ff.pointers)
+                indexes.pointer_vars.insert(sym_pair(to_module[pv.first], to_module[pv.second]));
+            for (auto &m : ff.memory)
+                memory_accesses.push_back(std::make_tuple(to_module[std::get<0>(m)], to_module[std::get<1>(m)], to_module[std::get<2>(m)]));
+            for (int g = 0; g < ff.gets.size(); g++) {
+                int v = ff.gets.var[g];
+                get_infos.add(v >= 0 ? var_row[v] : -1 - v, ff.gets.line[g], ff.gets.col[g], ff.gets.kind[g],
+                              ff.gets.value[g], to_module[ff.gets.file[g]], ff.gets.line_row[g], to_module[ff.gets.scope[g]],
+                              ff.gets.through[g]);
+            }
+
+            for (int c = 0; c < ff.calls.size(); c++)
+                function_calls.add(to_module[ff.calls.name[c]], to_module[ff.calls.scope[c]], ff.calls.line[c],
+                                   map_args(ff.calls.args_of(c)));
+        }
+
+        // run walk over every function in fns and merge what it found, in the
+        // order of fns. With -seminal-threads above 1 the functions are walked
+        // on that many threads, each into a function_facts of its own, and only
+        // merged once all are done.
+        void walk_functions(const vector<Function*> &fns,
+                            function_ref<void(Function &, function_facts &)> walk) {
+            size_t threads = std::min<size_t>(SeminalThreads, fns.size());
+            if (threads <= 1) {
+                for (Function *F : fns) {
+                    function_facts ff;
+                    walk(*F, ff);
+                    merge_function_facts(ff);
+                }
+                return;
+            }
+
+            vector<function_facts> facts(fns.size());
+            std::atomic<size_t> next(0);
+            vector<std::thread> workers;
+            for (size_t t = 0; t < threads; t++) {
+                workers.emplace_back([&] {
+                    for (size_t i = next++; i < fns.size(); i = next++)
+                        walk(*fns[i], facts[i]);
+                });
+            }
+            for (auto &w : workers) w.join();
+            for (auto &ff : facts) merge_function_facts(ff);
+        }
+
+        // fill variables_per_line from lineToVars and index it by line
+        void build_line_table() {
+            variables_per_line.clear();
+            for (const auto& lineEntry : lineToVars) {
+                SmallVector<sym, 8> vars(lineEntry.second.begin(), lineEntry.second.end());
+                // keep the variables of a line in name order, not intern order
+                std::sort(vars.begin(), vars.end(), [this](sym a, sym b) {
+                    return names.str(a) < names.str(b);
+                });
+                variables_per_line.add(lineEntry.first, vars);
+            }
+            build_line_index();
+        }
+
+        // index variables_per_line by line, once it has been filled
+        void build_line_index() {
+            indexes.lines.clear();
+            for (int i = 0; i < variables_per_line.size(); i++)
+                indexes.lines.emplace(variables_per_line.line_num[i], i);
+        }
+
+        // index functions and function_calls, once collection is done
+        void build_call_indexes() {
+            indexes.functions_by_name.clear();
+            indexes.functions_by_line.clear();
+            indexes.calls_by_line.clear();
+            indexes.calls_by_callee.clear();
+            indexes.calls_by_scope.clear();
+            indexes.input_calls_by_scope.clear();
+            indexes.arg_uses_by_line.clear();
+
+            for (int i = 0; i < functions.size(); i++) {
+                indexes.functions_by_name.emplace(functions.name[i], i);
+                indexes.functions_by_line[functions.line_num[i]].push_back(i);
+            }
+            for (int i = 0; i < function_calls.size(); i++) {
+                sym callee = function_calls.name[i];
+                indexes.calls_by_line[function_calls.line[i]].push_back(i);
+                indexes.calls_by_callee[callee].push_back(i);
+                indexes.calls_by_scope[function_calls.scope[i]].push_back(i);
+                if (callee == SYM_ISOC99_SCANF || callee == SYM_SCANF)
+                    indexes.input_calls_by_scope[function_calls.scope[i]].push_back(i);
+            }
+            for (size_t i = 0; i < arg_uses.size(); i++)
+                indexes.arg_uses_by_line[arg_uses[i].line].push_back(i);
+        }
+
+        // the scope the locations below the variable base in scope are kept
+        // in: a global's are the same in every function
+        sym location_scope(StringRef base, sym scope) {
+            auto m = names.ids.find(base);
+            return m != names.ids.end() && indexes.global_vars.count(m->second) ? SYM_GLOBAL : scope;
         }
 
-        void handleFunctionCall(CallInst* CI) {
-            Function* DirectF = CI->getCalledFunction();
-            Function* F = DirectF;
-            
-            // If there's no direct function, try to resolve the function pointer
-            if (!DirectF) {
-                Value* CalledValue = CI->getCalledOperand();
-                F = resolveFunctionPointer(CalledValue);
-            }
-            
-            // Skip if we couldn't resolve the function or if it's a debug intrinsic
-            if (!F || F->getName().startswith("llvm.dbg")) return;
-            
-            func_call_map fcm;
-            if (CI->getDebugLoc()) {
-                fcm.name = F->getName().str();
-                fcm.args = std::vector<param>();
-                
-                int ii = 0;
-                for (Use &U : CI->args()) {
-                    std::string argValue = getArgValue(U.get(), F);
-                    if (argValue.empty()) {
-                        fcm.args.push_back({-1, "unknown"});
-                    } else {
-                        fcm.args.push_back({ii, argValue});
-                        ii++;
-                    }
+        // index every location the facts name under the one a step above it,
+        // once the lines have their scopes
+        void build_location_index() {
+            indexes.locations_by_parent.clear();
+            std::set<pair<uint64_t, sym>> seen;
+            auto add = [&](sym loc, sym scope) {
+                StringRef text = names.str(loc);
+                if (!is_location(text)) return;
+                sym in = location_scope(text.take_front(location_base_length(text)), scope);
+                while (is_location(text)) {
+                    sym parent = names.intern(location_parent(text));
+                    if (!seen.insert({sym_pair(parent, in), loc}).second) return;
+                    indexes.locations_by_parent[sym_pair(parent, in)].push_back(loc);
+                    text = names.str(parent);
+                    loc = parent;
                 }
-                
-                fcm.scope = current_scope;
-                fcm.line = CI->getDebugLoc().getLine();
-                function_calls.push_back(fcm);
+            };
+            for (int l = 0; l < variables_per_line.size(); l++) {
+                for (sym va : variables_per_line.vars_of(l)) add(va, variables_per_line.scope[l]);
+            }
+            for (int v = 0; v < variable_infos.size(); v++)
+                add(variable_infos.name[v], variable_infos.scope[v]);
+            for (int c = 0; c < function_calls.size(); c++) {
+                for (const param &pa : function_calls.args_of(c)) add(pa.name, function_calls.scope[c]);
             }
         }
 
-        void processInstruction(Instruction* I) {
-            if (DbgDeclareInst* DDI = dyn_cast<DbgDeclareInst>(I)) {
-                printDbgValueInfo(DDI);
-            }
-            else if (StoreInst* SI = dyn_cast<StoreInst>(I)) {
-                traceStoreValue(SI);
+        // index the memory objects names may be, once globals are known. An
+        // object is shared if it is accessed as more than one variable or
+        // location; a global is the same one in every function.
+        void build_memory_index() {
+            indexes.memory_of.clear();
+            indexes.memory_names.clear();
+            indexes.shared_memory.clear();
+            std::set<std::tuple<sym, sym, sym>> seen;
+            std::unordered_map<sym, std::unordered_set<uint64_t>> accessed_as;
+            for (auto &ma : memory_accesses) {
+                if (!seen.insert(ma).second) continue;
+                sym name = std::get<0>(ma), scope = std::get<1>(ma), memory = std::get<2>(ma);
+                indexes.memory_of[sym_pair(name, scope)].push_back(memory);
+                indexes.memory_names[memory].push_back({name, scope});
+                StringRef text = names.str(name);
+                accessed_as[memory].insert(sym_pair(name, location_scope(text.take_front(location_base_length(text)), scope)));
             }
-            else if (CallInst* CI = dyn_cast<CallInst>(I)) {
-                handleFunctionCall(CI);
+            for (auto &aa : accessed_as) {
+                if (aa.second.size() > 1) indexes.shared_memory.insert(aa.first);
             }
         }
 
-        std::vector<unsigned int> targetLines = {11, 12, 13}; // Example line numbers
-        std::map<unsigned int, std::set<std::string>> lineToVars;
-
-        // Helper function to find debug declare instruction for a value
-        const DbgDeclareInst* findDbgDeclare(const Value *V) {
-            const Function *F = nullptr;
-            if (const Instruction *I = dyn_cast<Instruction>(V))
-                F = I->getFunction();
-            else if (const Argument *Arg = dyn_cast<Argument>(V))
-                F = Arg->getParent();
-            
-            if (!F) return nullptr;
+        template <typename K>
+        const vector<int>& lookup_all(const unordered_map<K, vector<int>> &m, const K &key) {
+            static const vector<int> none;
+            auto it = m.find(key);
+            return it == m.end() ? none : it->second;
+        }
 
-            for (const BasicBlock &BB : *F) {
-                for (const Instruction &I : BB) {
-                    if (const DbgDeclareInst *DDI = dyn_cast<DbgDeclareInst>(&I)) {
-                        if (DDI->getAddress() == V)
-                            return DDI;
-                    }
-                }
-            }
-            return nullptr;
+        // function that finds the index of variable in variable_infos with name=n and scope=s
+        // (a global with the same name always wins)
+        int find_variable_index_in_variable_infos(sym n, sym s) {
+            auto g = indexes.global_vars.find(n);
+            if (g != indexes.global_vars.end()) return g->second;
+            auto it = indexes.scoped_vars.find(sym_pair(n, s));
+            return it == indexes.scoped_vars.end() ? -1 : it->second;
         }
 
-        void trackGlobalVariables(Module &M) {
-            for (GlobalVariable &GV : M.globals()) {
-                if (DIGlobalVariableExpression* DIGVE = dyn_cast_or_null<DIGlobalVariableExpression>(
-                        GV.getMetadata(LLVMContext::MD_dbg))) {
-                    DIGlobalVariable *DGV = DIGVE->getVariable();
-                    unsigned line = DGV->getLine();
-                    lineToVars[line].insert(DGV->getName().str());
+        // the variable named name that a store in ff's function writes, as a
+        // function_facts::gets row: a global with the name always wins, then
+        // the first variable of that name declared in scope. Only reads
+        // the module's facts, which don't change while functions are walked.
+        bool find_function_variable(const function_facts &ff, sym name, sym scope, int &row) {
+            auto m = names.ids.find(ff.names.str(name));
+            if (m != names.ids.end()) {
+                auto g = indexes.global_vars.find(m->second);
+                if (g != indexes.global_vars.end()) {
+                    row = -1 - g->second;
+                    return true;
                 }
             }
+            auto it = ff.var_index.find(sym_pair(name, scope));
+            if (it == ff.var_index.end()) return false;
+            row = it->second;
+            return true;
         }
 
-        unordered_map<unsigned int, int> loop_map;
-
-        void getVariableNamesAtLine(const Instruction &I,  Function &F, LoopInfo &LI) {
-            const DebugLoc &DL = I.getDebugLoc();
-            if (!DL) return;
+        // function that finds the index of line in variables_per_line with line_num=l
+        int find_line_index_in_variables_per_line(int l) {
+            auto it = indexes.lines.find(l);
+            return it == indexes.lines.end() ? -1 : it->second;
+        }
 
-            unsigned int currentLine = DL.getLine();
-            auto &varNames = lineToVars[currentLine];
+        // function to find the index of function in functions with name=n
+        int find_function_index_in_functions(sym n) {
+            auto it = indexes.functions_by_name.find(n);
+            return it == indexes.functions_by_name.end() ? -1 : it->second;
+        }
 
-            if (isSourceLineInLoop(currentLine, F, LI)) {
-                // errs()<<"Line "<<currentLine<<" is in a loop\n";
-                loop_map[currentLine] = 1;
-            }else{
-                // errs()<<"Line "<<currentLine<<" is not in a loop\n";
-                loop_map[currentLine] = 0;
-            }
+        // whether the value a defined function returns depends on its argument
+        // at pos; unknown functions and positions are assumed to
+        bool returns_argument(sym callee, int pos) {
+            int f = find_function_index_in_functions(callee);
+            if (f == -1 || !summaries[f].done) return true;
+            const vector<bool> &rp = summaries[f].returns_param;
+            return size_t(pos) >= rp.size() || rp[pos];
+        }
 
-            // Check for DbgDeclareInst directly
-            if (const DbgDeclareInst *DDI = dyn_cast<DbgDeclareInst>(&I)) {
-                if (DILocalVariable *DIVar = DDI->getVariable()) {
-                    varNames.insert(DIVar->getName().str());
+        // recompute which parameters the value f returns depends on: start from
+        // the variables on its return lines, and go back through the lines they
+        // are assigned on in f. Arguments of defined functions on those lines
+        // only count if the callee's summary says so. Whether f's summary changed.
+        bool summarize_function(int f) {
+            sym scope = functions.name[f];
+            ArrayRef<param> params = functions.args_of(f);
+            vector<bool> returns(params.size(), false);
+            std::unordered_set<int> seen;
+            vector<int> work;
+            auto add_var = [&](sym va) {
+                int v = find_variable_index_in_variable_infos(va, scope);
+                if (v != -1 && seen.insert(v).second) work.push_back(v);
+                // a location in a parameter is read through the parameter
+                StringRef text = names.str(va);
+                auto m = names.ids.find(text.take_front(location_base_length(text)));
+                if (is_location(text) && m != names.ids.end()) {
+                    v = find_variable_index_in_variable_infos(m->second, scope);
+                    if (v != -1 && seen.insert(v).second) work.push_back(v);
                 }
-            }
-
-            // Check if this is a load instruction
-            if (const LoadInst *LI = dyn_cast<LoadInst>(&I)) {
-                // Check for global variables
-                if (const GlobalVariable *GV = dyn_cast<GlobalVariable>(LI->getPointerOperand())) {
-                    if (DIGlobalVariableExpression* DIGVE = dyn_cast_or_null<DIGlobalVariableExpression>(
-                            GV->getMetadata(LLVMContext::MD_dbg))) {
-                        DIGlobalVariable *DGV = DIGVE->getVariable();
-                        varNames.insert(DGV->getName().str());
-                    }
+            };
+            auto add_line = [&](int line) {
+                int l = find_line_index_in_variables_per_line(line);
+                if (l != -1) {
+                    for (sym va : variables_per_line.vars_of(l)) add_var(va);
                 }
-                // Check for local variables
-                if (const Value *V = LI->getPointerOperand()) {
-                    if (const DbgDeclareInst *DDI = findDbgDeclare(V)) {
-                        if (DILocalVariable *DIVar = DDI->getVariable()) {
-                            varNames.insert(DIVar->getName().str());
-                        }
-                    }
+                for (int u : lookup_all(indexes.arg_uses_by_line, line)) {
+                    if (returns_argument(arg_uses[u].callee, arg_uses[u].pos)) add_var(arg_uses[u].var);
                 }
-            }
-
-            // Check if this is a store instruction
-            if (const StoreInst *SI = dyn_cast<StoreInst>(&I)) {
-                // Check for global variables
-                if (const GlobalVariable *GV = dyn_cast<GlobalVariable>(SI->getPointerOperand())) {
-                    if (DIGlobalVariableExpression* DIGVE = dyn_cast_or_null<DIGlobalVariableExpression>(
-                            GV->getMetadata(LLVMContext::MD_dbg))) {
-                        DIGlobalVariable *DGV = DIGVE->getVariable();
-                        varNames.insert(DGV->getName().str());
-                    }
+            };
+
+            for (unsigned line : summaries[f].return_lines) add_line(line);
+            while (!work.empty()) {
+                int v = work.back();
+                work.pop_back();
+                if (variable_infos.scope[v] == scope && variable_infos.defined_at_line[v] == functions.line_num[f]) {
+                    for (auto &pa : params)
+                        if (pa.name == variable_infos.name[v] && pa.id >= 0 && size_t(pa.id) < returns.size()) returns[pa.id] = true;
                 }
-                // Check for local variables
-                if (const Value *V = SI->getPointerOperand()) {
-                    if (const DbgDeclareInst *DDI = findDbgDeclare(V)) {
-                        if (DILocalVariable *DIVar = DDI->getVariable()) {
-                            varNames.insert(DIVar->getName().str());
-                        }
-                    }
+                for (int g : variable_infos.gets_of(v)) {
+                    // a parameter's own store only copies in what the caller passed
+                    if (get_infos.scope[g] != scope || get_infos.kind[g] == STORE_PARAM) continue;
+                    add_line(get_infos.line[g]);
                 }
             }
 
-            // Add variables at their declaration points
-            for (const Use &U : I.operands()) {
-                if (const Value *V = U.get()) {
-                    if (const AllocaInst *AI = dyn_cast<AllocaInst>(V)) {
-                        if (const DbgDeclareInst *DDI = findDbgDeclare(AI)) {
-                            if (DILocalVariable *DIVar = DDI->getVariable()) {
-                                // Get the line number from the debug location of the alloca instruction
-                                if (const DebugLoc &AllocaLoc = AI->getDebugLoc()) {
-                                    lineToVars[AllocaLoc.getLine()].insert(DIVar->getName().str());
-                                }
-                                varNames.insert(DIVar->getName().str());
-                            }
-                        }
-                    }
-                }
-            }
+            bool changed = returns != summaries[f].returns_param;
+            summaries[f].returns_param = std::move(returns);
+            return changed;
         }
 
-        bool isSourceLineInLoop(unsigned int sourceLine, Function &F, LoopInfo &LI) {
-            for (BasicBlock &BB : F) {
-                for (Instruction &I : BB) {
-                    if (!I.getDebugLoc()) continue;
-                    
-                    unsigned int currentLine = I.getDebugLoc().getLine();
-                    
-                    // If we found an instruction at our target line
-                    if (currentLine == sourceLine) {
-                        // Need to pass the address of BB to getLoopFor
-                        Loop* L = LI.getLoopFor(&BB);
-                        if (!L) continue;
-                        
-                        // Get all the blocks in the loop
-                        auto loopBlocks = L->getBlocks();  // This returns an ArrayRef
-                        
-                        // Get the line range of the loop
-                        unsigned loopStartLine = UINT_MAX;
-                        unsigned loopEndLine = 0;
-                        
-                        for (BasicBlock* loopBB : loopBlocks) {
-                            for (Instruction &loopInst : *loopBB) {
-                                if (loopInst.getDebugLoc()) {
-                                    unsigned instLine = loopInst.getDebugLoc().getLine();
-                                    loopStartLine = std::min(loopStartLine, instLine);
-                                    loopEndLine = std::max(loopEndLine, instLine);
-                                }
-                            }
-                        }
-                        
-                        // Check if our source line falls within the loop's range
-                        if (sourceLine >= loopStartLine && sourceLine <= loopEndLine) {
-                            return true;
-                        }
-                    }
-                }
+        // summarize the functions of one strongly connected component of the
+        // call graph. A recursive component starts from "depends on nothing"
+        // and is recomputed until no summary changes.
+        void summarize_component(const vector<int> &component, bool recursive) {
+            for (int f : component) {
+                summaries[f].returns_param.assign(functions.args_of(f).size(), false);
+                summaries[f].done = true;
+            }
+            summary_stats.components++;
+            if (recursive) summary_stats.recursive++;
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                summary_stats.rounds++;
+                for (int f : component) changed |= summarize_function(f);
             }
-            return false;
         }
 
-        std::vector<pair<int, string>> readBranchInfo() {
-            std::ifstream file("branch_info.txt");
-            std::set<unsigned int> uniqueLines;  // Using set for unique numbers
-            vector<string> branch_id;
-            std::string line;
-
-            if (!file.is_open()) {
-                errs() << "Error: Could not open branch_info.txt\n";
-                return std::vector<pair<int,string>>();
+        // summarize every function, callees first: each strongly connected
+        // component of the call graph after every component it calls into
+        void summarize_functions() {
+            int nf = functions.size();
+            vector<vector<int>> callees(nf);
+            for (int c = 0; c < function_calls.size(); c++) {
+                int caller = find_function_index_in_functions(function_calls.scope[c]);
+                int callee = find_function_index_in_functions(function_calls.name[c]);
+                if (caller != -1 && callee != -1) callees[caller].push_back(callee);
             }
 
-            while (std::getline(file, line)) {
-                // Skip empty lines
-                if (line.empty()) continue;
+            for_each_component(nf, [&](int f) { return callees[f].size(); },
+                               [&](int f, size_t i) { return callees[f][i]; },
+                               [&](vector<int> &component) {
+                int f = component[0];
+                bool recursive = component.size() > 1 ||
+                                 std::find(callees[f].begin(), callees[f].end(), f) != callees[f].end();
+                // keep the functions of a component in module order
+                std::sort(component.begin(), component.end());
+                // summarized in an earlier -seminal-demand round: a slice
+                // holds every callee, so the functions added since are not in it
+                if (std::all_of(component.begin(), component.end(), [&](int g) { return summaries[g].done; })) return;
+                summarize_component(component, recursive);
+            });
+        }
 
-                // Find position of first comma
-                size_t pos = line.find(',');
-                if (pos == std::string::npos) continue;
+        struct {
+            size_t components = 0;      // strongly connected components of the call graph
+            size_t recursive = 0;       // of them, the ones that call themselves
+            size_t rounds = 0;          // summary rounds over all components
+        } summary_stats;
+
+        // the definitions of (name, scope) that reach the lines it is read on,
+        // null when every assignment counts: -seminal-defs=lines, or a variable
+        // the reaching definitions pass does not track, like a global
+        const vector<pair<unsigned, unsigned>>* reaching_defs_of(sym name, sym scope) const {
+            if (SeminalDefs != DEFS_REACHING) return nullptr;
+            auto it = indexes.reaching_defs.find(sym_pair(name, scope));
+            return it == indexes.reaching_defs.end() ? nullptr : &it->second;
+        }
 
-                // Extract the part after the comma and trim whitespace
-                std::string numberPart = line.substr(pos + 1);
-                pos = numberPart.find(',');
-                if (pos == std::string::npos) continue;
+        // the line a flow node for (name, scope) read on line is keyed by: -1
+        // unless its reaching definitions tell lines apart
+        int flow_node_line(sym name, sym scope, int line) const {
+            return line != -1 && reaching_defs_of(name, scope) ? line : -1;
+        }
 
-                // Extract the number and trim whitespace
-                std::string numberStr = numberPart.substr(0, pos);
-                // Remove leading/trailing spaces
-                numberStr.erase(0, numberStr.find_first_not_of(" "));
-                numberStr.erase(numberStr.find_last_not_of(" ") + 1);
+        // the flow node for name in scope, read on line in context, created on
+        // first use
+        int get_flow_node(sym name, sym scope, int line, int context = 0) {
+            line = flow_node_line(name, scope, line);
+            vector<int> &nodes = indexes.flow_nodes[sym_pair(name, scope)];
+            for (int n : nodes)
+                if (flow_nodes[n].line == line && flow_nodes[n].context == context) return n;
+
+            flow_node fn;
+            fn.name = name;
+            fn.scope = scope;
+            fn.var = find_variable_index_in_variable_infos(name, scope);
+            fn.line = line;
+            fn.context = context;
+            fn.expanded = false;
+            fn.edges = {0, 0};
+            flow_nodes.push_back(fn);
+            nodes.push_back(flow_nodes.size() - 1);
+            return flow_nodes.size() - 1;
+        }
 
-                // Convert to integer and add to set
-                unsigned int lineNum = std::stoi(numberStr);
-                uniqueLines.insert(lineNum);
+        ArrayRef<flow_edge> edges_of(int n) const { return arena_slice(flow_edges, flow_nodes[n].edges); }
 
-                // Extract the branch id
-                // find position of first ':'
-                size_t pos2 = line.find(':');
-                if (pos2 == std::string::npos) continue;
+        // the flow node for name in scope read on line, in any context, -1 if
+        // the search never created it
+        int find_flow_node(sym name, sym scope, int line) const {
+            line = flow_node_line(name, scope, line);
+            auto it = indexes.flow_nodes.find(sym_pair(name, scope));
+            if (it == indexes.flow_nodes.end()) return -1;
+            for (int n : it->second)
+                if (flow_nodes[n].line == line && flow_nodes[n].context == 0) return n;
+            return -1;
+        }
 
-                // Extract the part before the ':'
-                std::string branch_id_str = line.substr(0, pos2);
-                branch_id.push_back(branch_id_str);
+        // the input read by call into var, created on first use
+        int get_input_source(source_kind kind, int call, sym var) {
+            auto key = std::make_tuple((int)kind, call, var);
+            auto it = indexes.sources.find(key);
+            if (it != indexes.sources.end()) return it->second;
+
+            ArrayRef<param> args = function_calls.args_of(call);
+            input_source src;
+            src.kind = kind;
+            src.var = var;
+            src.path = (kind == SRC_FOPEN || kind == SRC_FREAD) && args.size() > 0 ? args[0].name : SYM_EMPTY;
+            src.mode = kind == SRC_FOPEN && args.size() > 1 ? args[1].name : SYM_EMPTY;
+            src.call = call;
+            input_sources.push_back(src);
+            indexes.sources.emplace(key, input_sources.size() - 1);
+            return input_sources.size() - 1;
+        }
 
+        // work out where the value of flow node n comes from: the inputs it
+        // reads itself and the flow nodes its value is copied from
+        void expand_flow_node(int n) {
+            if (flow_nodes[n].expanded) return;
+            flow_nodes[n].expanded = true;
+            int v = flow_nodes[n].var;
+
+            // copies, since creating nodes below can move flow_nodes
+            const sym var_name = flow_nodes[n].name;
+            const sym scope = flow_nodes[n].scope;
+            const int line = flow_nodes[n].line;
+            const int context = flow_nodes[n].context;
+            vector<flow_edge> edges;
+            vector<int> direct;
+            if (SeminalDemand) demand_node(var_name, scope);
+
+            // a memory object gets its value from every name it is accessed as
+            if (scope == SYM_MEMORY) {
+                auto names_of = indexes.memory_names.find(var_name);
+                if (names_of != indexes.memory_names.end()) {
+                    for (auto &na : names_of->second) {
+                        // with calling contexts, names in a parameter are
+                        // reached from the calls that pass the memory in
+                        StringRef member = names.str(na.first);
+                        int pf;
+                        if (context_k > 0 && parameter_position(member.take_front(location_base_length(member)), na.second, pf) != -1)
+                            continue;
+                        edges.push_back({get_flow_node(na.first, na.second, -1), -1, -1, false});
+                    }
+                }
+                flow_nodes[n].edges = arena_append(flow_edges, ArrayRef<flow_edge>(edges));
+                return;
             }
 
-            file.close();
+            // a location only read, never stored to, has no variable row but
+            // still gets its value from inputs, callers and what contains it
+            const StringRef text = names.str(var_name);
+            const StringRef base = text.take_front(location_base_length(text));
+            const bool location = is_location(text);
+            if (v == -1 && !location) return;
+
+            // whether the definition on def_line reaches the line the node is
+            // read on; line 0 stands for the value the function was entered with
+            const vector<pair<unsigned, unsigned>> *defs = line == -1 ? nullptr : reaching_defs_of(var_name, scope);
+            auto reaches = [&](unsigned def_line) {
+                return !defs || std::binary_search(defs->begin(), defs->end(), make_pair((unsigned)line, def_line));
+            };
+            // the line a variable is read on at line used: only kept when
+            // reaching definitions are followed
+            auto read_on = [&](int used) { return SeminalDefs == DEFS_REACHING ? used : -1; };
+            // whether the function may have been entered by call ci: any
+            // call without a context, otherwise only its most recent call
+            auto entered_by = [&](int ci) { return context == 0 || contexts.top(context) == ci; };
+            const int caller_context = context == 0 ? 0 : contexts.pop(context);
+
+            // an argument of scanf gets its value from the user, nothing else matters
+            for (int ci : lookup_all(indexes.input_calls_by_scope, scope)) {
+                if (!reaches(function_calls.line[ci])) continue;
+                ArrayRef<param> args = function_calls.args_of(ci);
+                // Start from index 1 since first argument is format string
+                for (size_t i = 1; i < args.size(); i++) {
+                    if (args[i].name == var_name || location_within(text, names.str(args[i].name))) {
+                        direct.push_back(get_input_source(SRC_SCANF, ci, args[i].name));
+                        break;
+                    }
+                }
+            }
 
-            vector<unsigned int> uu = std::vector<unsigned int>(uniqueLines.begin(), uniqueLines.end());
-            std::vector<pair<int, string>> branch_info;
-            for(int i = 0; i < branch_id.size(); i++) {
-                branch_info.push_back({uu[i], branch_id[i]});
+            // a parameter gets its value from the arguments at every call site
+            bool has_callers = false;
+            if (direct.empty() && reaches(0) && !location) {
+                for (int fi : lookup_all(indexes.functions_by_line, variable_infos.defined_at_line[v])) {
+                    sym fname = functions.name[fi];
+                    int arg_index = 0;
+                    for (auto &pa : functions.args_of(find_function_index_in_functions(fname)))
+                        if (pa.name == var_name) arg_index = pa.id;
+                    for (int ci : lookup_all(indexes.calls_by_callee, fname)) {
+                        ArrayRef<param> args = function_calls.args_of(ci);
+                        sym caller = function_calls.scope[ci];
+                        if (!entered_by(ci) || arg_index < 0 || size_t(arg_index) >= args.size()) continue;
+                        sym arg = args[arg_index].name;
+                        // prevent infinte recursion
+                        if (arg == var_name && caller == scope) continue;
+                        has_callers = true;
+                        if (arg != SYM_UNKNOWN)
+                            edges.push_back({get_flow_node(arg, caller, read_on(function_calls.line[ci]), caller_context), ci, -1, false});
+                    }
+                }
             }
-            return branch_info;
-        }
 
-        // function that finds the index of variable in variable_infos with name=n and scope=s
-        int find_variable_index_in_variable_infos(string n, string s) {
-            for (int i = 0; i < variable_infos.size(); i++) {
-                if(variable_infos[i].name == n && variable_infos[i].scope == "global") return i;
-                if (variable_infos[i].name == n && variable_infos[i].scope == s) {
-                    return i;
+            // a location in a parameter gets its value from the same location
+            // in the argument at every call site, and from what the function
+            // stores to it
+            int f;
+            int pos = location ? parameter_position(base, scope, f) : -1;
+            if (direct.empty() && reaches(0) && pos != -1) {
+                for (int ci : lookup_all(indexes.calls_by_callee, functions.name[f])) {
+                    ArrayRef<param> args = function_calls.args_of(ci);
+                    if (!entered_by(ci) || size_t(pos) >= args.size() || args[pos].name == SYM_UNKNOWN) continue;
+                    StringRef arg = names.str(args[pos].name);
+                    if (arg.empty() || !(isalpha(arg[0]) || arg[0] == '_')) continue;
+                    sym target = names.intern(location_append(arg, text.drop_front(base.size())));
+                    sym caller = function_calls.scope[ci];
+                    if (target == var_name && caller == scope) continue;
+                    edges.push_back({get_flow_node(target, caller, read_on(function_calls.line[ci]), caller_context), ci, -1, false});
                 }
             }
-            return -1;
-        }
 
-        // function that finds the index of line in variables_per_line with line_num=l
-        int find_line_index_in_variables_per_line(int l) {
-            for (int i = 0; i < variables_per_line.size(); i++) {
-                if (variables_per_line[i].line_num == l) {
-                    return i;
+            // otherwise it gets its value at each line it is assigned on: from an
+            // input call on that line and from every other variable on it. A
+            // parameter with callers keeps the stores through it (*p = t), which
+            // write to what the callers passed in.
+            if (direct.empty() && v != -1) {
+                for (int g : variable_infos.gets_of(v)) {
+                    if (has_callers && !get_infos.through[g]) continue;
+                    if (!reaches(get_infos.line[g])) continue;
+                    for (int ci : lookup_all(indexes.calls_by_line, get_infos.line[g])) {
+                        sym fname = function_calls.name[ci];
+                        if (fname == SYM_FOPEN)
+                            direct.push_back(get_input_source(SRC_FOPEN, ci, var_name));
+                        else if (fname == SYM_FREAD)
+                            direct.push_back(get_input_source(SRC_FREAD, ci, var_name));
+                        else if (fname == SYM_SCANF || fname == SYM_ISOC99_SCANF)
+                            direct.push_back(get_input_source(SRC_INPUT, ci, var_name));
+                    }
+                    sym get_scope = get_infos.scope[g];
+                    for (sym va : variables_per_line.vars_of(get_infos.line_row[g])) {
+                        if (va != var_name)
+                            edges.push_back({get_flow_node(va, get_scope, read_on(get_infos.line[g]), get_scope == scope ? context : 0), -1, g, false});
+                    }
                 }
             }
-            return -1;
-        }
 
-        // function to find the index of function in functions with name=n
-        int find_function_index_in_functions(string n) {
-            for (int i = 0; i < functions.size(); i++) {
-                if (functions[i].name == n) {
-                    return i;
+            // a variable passed by address to a defined function gets its
+            // value from what the function stores through its parameter: in
+            // the context of that call, or with k=0 in the one every caller
+            // shares
+            if (direct.empty()) {
+                for (int ci : lookup_all(indexes.calls_by_scope, scope)) {
+                    int cf = find_function_index_in_functions(function_calls.name[ci]);
+                    if (cf == -1) continue;
+                    ArrayRef<param> args = function_calls.args_of(ci);
+                    for (const param &pa : functions.args_of(cf)) {
+                        if (pa.id < 0 || size_t(pa.id) >= args.size() || args[pa.id].name == SYM_UNKNOWN) continue;
+                        StringRef arg = names.str(args[pa.id].name);
+                        if (args[pa.id].name != var_name && !location_within(text, arg)) continue;
+                        if (!indexes.pointer_vars.count(sym_pair(pa.name, functions.name[cf]))) continue;
+                        sym target = names.intern(location_append(names.str(pa.name), text.drop_front(arg.size())));
+                        edges.push_back({get_flow_node(target, functions.name[cf], -1, contexts.push(context, ci, context_k)), ci, -1, true});
+                    }
                 }
             }
-            return -1;
-        }
 
-        // function to find the index of function in function_calls with line=l
-        int find_function_index_in_functions_line(int l) {
-            for (int i = 0; i < functions.size(); i++) {
-                if (functions[i].line_num == l) {
-                    return i;
+            // reading a variable or a location reads every location below it.
+            // One reached through a pointer also gets its value from wherever
+            // the pointer was taken from, unless a caller passed the pointer in.
+            if (direct.empty()) {
+                sym in = location_scope(base, scope);
+                auto below = indexes.locations_by_parent.find(sym_pair(var_name, in));
+                if (below != indexes.locations_by_parent.end()) {
+                    for (sym loc : below->second)
+                        edges.push_back({get_flow_node(loc, scope, line, context), -1, -1, false});
+                }
+                if (location) {
+                    StringRef parent_text = location_parent(text);
+                    sym parent = names.intern(parent_text);
+                    int pf;
+                    if (indexes.pointer_vars.count(sym_pair(parent, in)) && parameter_position(parent_text, scope, pf) == -1)
+                        edges.push_back({get_flow_node(parent, scope, line, context), -1, -1, false});
+                }
+                // memory it may share with other names, through pointers
+                // held elsewhere or in other functions. With calling contexts,
+                // a name in a parameter reaches it through the calls instead
+                auto memory = indexes.memory_of.find(sym_pair(var_name, scope));
+                int mf;
+                if (memory != indexes.memory_of.end() && !(context_k > 0 && parameter_position(base, scope, mf) != -1)) {
+                    for (sym m : memory->second) {
+                        if (indexes.shared_memory.count(m))
+                            edges.push_back({get_flow_node(m, SYM_MEMORY, -1), -1, -1, false});
+                    }
                 }
             }
+
+            flow_nodes[n].edges = arena_append(flow_edges, ArrayRef<flow_edge>(edges));
+            flow_nodes[n].direct = direct;
+        }
+
+        // position of name among the parameters of the function scope names,
+        // -1 if it is not one of them; f is that function
+        int parameter_position(StringRef name, sym scope, int &f) {
+            f = find_function_index_in_functions(scope);
+            auto m = names.ids.find(name);
+            if (f == -1 || m == names.ids.end()) return -1;
+            int v = find_variable_index_in_variable_infos(m->second, scope);
+            if (v == -1 || variable_infos.scope[v] != scope || variable_infos.defined_at_line[v] != functions.line_num[f]) return -1;
+            for (auto &pa : functions.args_of(f))
+                if (pa.name == m->second) return pa.id;
             return -1;
         }
 
-        int find_function_index_in_function_calls(string n) {
-            for (int i = 0; i < function_calls.size(); i++) {
-                if (function_calls[i].name == n) {
-                    return i;
+        std::unordered_set<const Function*> walked;    // functions whose facts are collected
+        std::set<pair<size_t, Function*>> demanded;    // functions the search needs that were not walked, in module order
+        size_t demand_rounds = 0;
+
+        // the function a line of the source is in: the last one starting
+        // before it, like the scopes of the lines
+        Function* functionAtLine(const vector<Function*> &defined, unsigned line) {
+            Function* at = nullptr;
+            unsigned start = 0;
+            for (Function* F : defined) {
+                DISubprogram* SP = F->getSubprogram();
+                if (SP && SP->getLine() <= line && (!at || SP->getLine() >= start)) {
+                    at = F;
+                    start = SP->getLine();
                 }
             }
-            return -1;
+            return at;
         }
 
-        // function to find the index of function in function_calls with line=l
-        int find_function_index_in_function_calls_line(int l) {
-            for (int i = 0; i < function_calls.size(); i++) {
-                if (function_calls[i].line == l) {
-                    return i;
+        // walk F from now on, and every defined function it may call: their
+        // summaries decide which arguments count on F's lines
+        void add_to_slice(Function* F) {
+            vector<Function*> work = {F};
+            while (!work.empty()) {
+                Function* G = work.back();
+                work.pop_back();
+                if (G->isDeclaration() || !walked.insert(G).second) continue;
+                for (Instruction &I : instructions(*G)) {
+                    const CallBase* CB = dyn_cast<CallBase>(&I);
+                    if (!CB || isa<DbgInfoIntrinsic>(CB)) continue;
+                    SmallVector<Function*, 2> targets;
+                    calledFunctions(*CB, targets);
+                    work.insert(work.end(), targets.begin(), targets.end());
                 }
             }
-            return -1;
         }
 
-        bool seminal = false;
-        vector<pair<string, string>> visited;
-        string current_branch_id = "";
+        void demand(Function* F) {
+            if (!F->isDeclaration() && !walked.count(F)) demanded.insert({function_order.at(F), F});
+        }
 
-        void do_analysis(string var_name, string scope, vector<string> s, bool found=false) {
-            // check if we have already visited this variable in this scope
-            for (auto &v : visited) {
-                if (v.first == var_name && v.second == scope) {
-                    return;
-                }
+        // demand every function with an instruction using V, directly or
+        // through constant expressions
+        void demand_users(const Value* V) {
+            for (const User* U : V->users()) {
+                if (const Instruction* I = dyn_cast<Instruction>(U)) demand(const_cast<Function*>(I->getFunction()));
+                else if (isa<ConstantExpr>(U)) demand_users(U);
             }
-            // find the variable in variable_infos
-            int v = find_variable_index_in_variable_infos(var_name, scope);
-            if (v == -1) {
-                // errs() << "Variable " << var_name << " not found in variable_infos\n";
+        }
+
+        // with -seminal-demand, the functions the edges of the flow node for
+        // name in scope come from but that were not walked: the callers of a
+        // parameter's function, the functions using a global, and the
+        // functions that may access the memory the name may be
+        void demand_node(sym name, sym scope) {
+            StringRef text = names.str(name);
+            StringRef base = text.take_front(location_base_length(text));
+            if (scope == SYM_MEMORY) {
+                auto c = object_classes.find(base);
+                if (c == object_classes.end()) return;
+                for (int cl : c->second) {
+                    for (Function* F : class_functions[cl]) demand(F);
+                    for (const GlobalVariable* GV : class_globals[cl]) demand_users(GV);
+                }
                 return;
             }
-            
-            var_map vm = variable_infos[v];
-            bool done = false;
-
-            visited.push_back({var_name, scope});
-
-
-            for (const auto& fcall : function_calls) {
-                if (fcall.scope == scope && (fcall.name == "__isoc99_scanf" || fcall.name == "scanf")) {
-                    // Start from index 1 since first argument is format string
-                    for (size_t i = 1; i < fcall.args.size(); i++) {
-                        // errs() << "Checking if " << fcall.args[i].name << " is equal to " << var_name << "\n";
-                        if (fcall.args[i].name == var_name) {
-                            string ss = "#:" + var_name + " gets value from user input via scanf";
-                            s.push_back(ss);
-                            found = true;
-                            done = true;
-                            break;
-                        }
+            auto g = globals_by_name.find(base);
+            int f;
+            if (g != globals_by_name.end()) {
+                demand_users(g->second);
+            } else if (parameter_position(base, scope, f) != -1) {
+                if (Function* F = module->getFunction(names.str(scope))) {
+                    demand_users(F);
+                    for (auto &ct : call_targets) {
+                        if (llvm::is_contained(ct.second, F)) demand(const_cast<Function*>(ct.first->getFunction()));
                     }
                 }
             }
+            auto mo = indexes.memory_of.find(sym_pair(name, scope));
+            if (mo != indexes.memory_of.end()) {
+                for (sym m : mo->second) demand_node(m, SYM_MEMORY);
+            }
+        }
 
-            if (done) {
-                if (found && !seminal) {
-                    // errs() << "Branch is seminal  source code line: "<< current_line << " branch ID: "<< current_branch_id <<"\n";
-                    // for(auto &ss: s) {
-                    //     errs() << "  " << ss << "\n";
-                    // }
-                    // errs() << "\n";
-                    std::ofstream out("def-use-out.txt", std::ios_base::app);
-                    out << "Branch is seminal source code line: "<< current_line << " branch ID: "<< current_branch_id <<"\n";
-                    for(auto &ss: s) {
-                        out << "  " << ss << "\n";
+        // forget the flow graph, to build it again from the facts
+        void clear_flow_graph() {
+            flow_nodes.clear();
+            flow_edges.clear();
+            provenance.clear();
+            indexes.flow_nodes.clear();
+            input_sources.clear();
+            indexes.sources.clear();
+            contexts.clear();
+        }
+
+        // expand every flow node the variables on a branch line depend on.
+        // Queries only read the graph afterwards, so they can run on several
+        // threads, and nodes and inputs are numbered the same way whatever the
+        // number of threads.
+        void expand_branch(int line) {
+            int l = find_line_index_in_variables_per_line(line);
+            if (l == -1) return;
+
+            sym scope = variables_per_line.scope[l];
+            for (sym va : variables_per_line.vars_of(l)) {
+                int n = get_flow_node(va, scope, line);
+                if (flow_nodes[n].expanded) continue;
+
+                std::unordered_set<int> queued = {n};
+                std::deque<int> work = {n};
+                while (!work.empty()) {
+                    int m;
+                    if (SeminalVisitOrder == VISIT_BFS) {
+                        m = work.front();
+                        work.pop_front();
+                    } else {
+                        m = work.back();
+                        work.pop_back();
+                    }
+                    expand_flow_node(m);
+                    for (size_t e = 0; e < edges_of(m).size(); e++) {
+                        int t = edges_of(m)[e].target;
+                        if (flow_nodes[t].expanded || !queued.insert(t).second) continue;
+                        work.push_back(t);
                     }
-                    out << "\n";
-                    out.close();
-                    seminal_output[current_line] = s;
-                    seminal = true;
                 }
-                return;
             }
-            
-            for(auto &f: functions) {
-                if(f.line_num == vm.defined_at_line) {
-                    int fci = find_function_index_in_functions(f.name);
-                    string ss = "";
-                    ss += var_name + " defined as a parameter in function " + f.name;
-                    s.push_back(ss);
-                    func_map fm = functions[fci];
-                    int arg_index = 0;
-                    for(auto &pa: fm.args) 
-                        if(pa.name == var_name) {arg_index = pa.id;}
-                    for (int i = 0; i < function_calls.size(); i++) {
-                        if (function_calls[i].name == f.name) {
-                            func_call_map fcm = function_calls[i];
-                            fcm.args[arg_index].name;    
-                            // prevent infinte recursion
-                            if(fcm.args[arg_index].name == var_name && fcm.scope == scope)
-                                continue;
-                            else{
-                                ss = "";
-                                ss += var_name + " gets value from argument " + fcm.args[arg_index].name + " in function call to " + f.name;
-                                s.push_back(ss);
-                                do_analysis(fcm.args[arg_index].name, fcm.scope, s);
-                                done = true;
-                            }
+        }
 
-                        }
+        // what one thread answering branch queries keeps to itself
+        struct query_worker {
+            worklist_stats stats = {0, 0, 0, 0};
+            vector<uint32_t> seen;  // query a node was last queued in
+            uint32_t query = 0;
+        };
+
+        bool is_resolved(int n) const {
+            return flow_states[n].load(std::memory_order_acquire) == FLOW_RESOLVED;
+        }
+
+        // n is resolved, but another thread may still be storing its sources
+        void wait_resolved(int n) const {
+            while (!is_resolved(n)) std::this_thread::yield();
+        }
+
+        // resolve the input sources of flow node n and of every unresolved node
+        // it gets its value from, without recursion. Other threads may resolve
+        // some of the same nodes at the same time; they find the same sources.
+        void resolve_flow_node(int n, query_worker &qw) {
+            if (!is_resolved(n)) {
+                qw.query++;
+                vector<int> region;
+                std::deque<int> work;
+                qw.seen[n] = qw.query;
+                work.push_back(n);
+                while (!work.empty()) {
+                    qw.stats.discover_high_water = std::max(qw.stats.discover_high_water, work.size());
+                    int m;
+                    if (SeminalVisitOrder == VISIT_BFS) {
+                        m = work.front();
+                        work.pop_front();
+                    } else {
+                        m = work.back();
+                        work.pop_back();
+                    }
+                    region.push_back(m);
+                    for (auto &edge : edges_of(m)) {
+                        int t = edge.target;
+                        if (qw.seen[t] == qw.query || is_resolved(t)) continue;
+                        qw.seen[t] = qw.query;
+                        work.push_back(t);
                     }
                 }
+
+                solve_flow_region(region, qw);
+                qw.stats.queries++;
+                qw.stats.nodes += region.size();
             }
-            
-            if(done) return;
+            wait_resolved(n);
+        }
 
-            bool found_val = false;
+        const reached_source* find_reached(const flow_node &fn, int source) const {
+            auto it = std::lower_bound(fn.sources.begin(), fn.sources.end(), source,
+                                       [](const reached_source &rs, int s) { return rs.source < s; });
+            return it != fn.sources.end() && it->source == source ? &*it : nullptr;
+        }
 
-            // find where it gets value from
-            for (auto &gl : vm.gets_value_infos) {
-                // errs()<<"analyzing line: "<<gl.code<<"\n";
-                
-                // check if there is a function call on the same line, and analyze each function.
-                for(int i = 0; i < function_calls.size(); i++) {
-                    if(function_calls[i].line == gl.gets_at_line) {
-                        // check if the name is part of the input functions
-                        string fname = function_calls[i].name;
-                        if(fname == "getc" || fname == "fgetc") {
-                            string ss = "";
-                            ss += "#: " + var_name + " gets value from each character in variable called " + function_calls[i].args[0].name;
-                            s.push_back(ss);
-                            found_val=false;
-                        }else if(fname == "fopen"){
-                            string ss = "";
-                            ss += "#: " + var_name + " gets value from file at path " + function_calls[i].args[0].name + " opened in mode " + function_calls[i].args[1].name;
-                            s.push_back(ss);
-                            found_val = true;
-                        } else if(fname == "fread"){
-                            string ss = "";
-                            ss += "#: " + var_name + " gets value from file buffer named " + function_calls[i].args[0].name;
-                            s.push_back(ss);
-                            found_val = true;
-                        } else if(fname == "scanf" || fname == "__isoc99_scanf"){
-                            string ss = "";
-                            ss += "#: " + var_name + " gets value from user input";
-                            s.push_back(ss);
-                            found_val = true;
-                        }
+        // give every member of a region the union of the sources reaching it,
+        // with the shortest chain to each. Candidates are handled by length:
+        // the inputs a member reads itself have length 0, an edge to a node
+        // resolved earlier adds one to that node's length, and every (member,
+        // source) settled at one length offers length + 1 to the members with
+        // an edge to it. Among candidates of the same length the first edge
+        // wins, so the result is the same whatever order the work was done in.
+        // Once a length is settled its chains are interned, on top of the
+        // chains one shorter they continue with.
+        void solve_flow_region(const vector<int> &members, query_worker &qw) {
+            std::unordered_map<int, std::unordered_map<int, reached_source>> got;   // member -> source -> best
+            std::unordered_map<int, vector<pair<int, int>>> feeds;                  // member -> (member, edge) it feeds
+            std::map<int, vector<std::tuple<int, int, int>>> candidates;           // length -> (member, source, edge)
+            std::unordered_map<int, std::unordered_map<int, int>> edge_of;          // member -> source -> edge taken
+            for (int m : members) got[m];
+
+            for (int m : members) {
+                for (int src : flow_nodes[m].direct)
+                    candidates[0].push_back({m, src, -1});
+                for (int e = 0; e < (int)edges_of(m).size(); e++) {
+                    int t = edges_of(m)[e].target;
+                    if (got.count(t)) {
+                        feeds[t].push_back({m, e});
+                        continue;
                     }
+                    for (auto &rs : flow_nodes[t].sources)
+                        candidates[rs.length + 1].push_back({m, rs.source, e});
                 }
+            }
 
-                if(gl.vars.vars.size() == 0){
-                    return;
-                };
-
-                for (auto &va : gl.vars.vars) {
-                    if(va.name != var_name) {
-                        // errs()<<"going to analyzing variable: "<<va.name<<"\n";
-                        do_analysis(va.name, gl.vars.scope, s, found_val);
+            while (!candidates.empty()) {
+                int length = candidates.begin()->first;
+                vector<std::tuple<int, int, int>> level = std::move(candidates.begin()->second);
+                candidates.erase(candidates.begin());
+                qw.stats.propagate_high_water = std::max(qw.stats.propagate_high_water, level.size());
+
+                vector<pair<int, int>> settled;
+                for (auto &c : level) {
+                    int m = std::get<0>(c), src = std::get<1>(c), e = std::get<2>(c);
+                    auto &g = got[m];
+                    if (g.emplace(src, reached_source{src, length, -1}).second) {
+                        edge_of[m][src] = e;
+                        settled.push_back({m, src});
+                    } else if (g[src].length == length && e < edge_of[m][src]) {
+                        edge_of[m][src] = e;
+                    }
+                }
+                for (auto &ms : settled) {
+                    int m = ms.first, src = ms.second;
+                    int e = edge_of[m][src];
+                    int parent = -1;
+                    if (e != -1) {
+                        int t = edges_of(m)[e].target;
+                        auto in = got.find(t);
+                        parent = in != got.end() ? in->second[src].chain : find_reached(flow_nodes[t], src)->chain;
+                    }
+                    got[m][src].chain = provenance.intern(m, e, e == -1 ? src : -1, parent);
+                    for (auto &fe : feeds[m]) {
+                        if (!got[fe.first].count(src))
+                            candidates[length + 1].push_back({fe.first, src, fe.second});
                     }
                 }
             }
 
-            if( (found_val || found) && !seminal ) {
-                // errs() << "Branch is seminal source code line: "<< current_line << " branch ID: "<< current_branch_id <<"\n";
-                // for(auto &ss: s) {
-                //     errs() << "  " << ss << "\n";
-                // }
-                // errs() << "\n";
-                // write contents of s to a file called def-use-out.txt (append if there is content already)
-                std::ofstream out("def-use-out.txt", std::ios_base::app);
-                out << "Branch is seminal source code line: "<< current_line << " branch ID: "<< current_branch_id <<"\n";
-                for(auto &ss: s) {
-                    out << "  " << ss << "\n";
+            for (int m : members) {
+                vector<reached_source> sources;
+                for (auto &sc : got[m]) sources.push_back(sc.second);
+                std::sort(sources.begin(), sources.end(),
+                          [](const reached_source &a, const reached_source &b) { return a.source < b.source; });
+                uint8_t expected = FLOW_UNRESOLVED;
+                if (flow_states[m].compare_exchange_strong(expected, FLOW_PUBLISHING)) {
+                    flow_nodes[m].sources = std::move(sources);
+                    flow_states[m].store(FLOW_RESOLVED, std::memory_order_release);
                 }
-                out << "\n";
-                out.close();
-                seminal_output[current_line] = s;
-                seminal = true;
             }
         }
 
-        bool debug = false;
+        // the steps explaining how resolved node n gets source, from n to the
+        // node that reads it
+        vector<prov_step> chain_of(int n, int source) {
+            wait_resolved(n);
+            return provenance.chain(find_reached(flow_nodes[n], source)->chain);
+        }
 
-        int current_line = 0;
-        unordered_map<int, vector<string>> seminal_output;
-
-        std::vector<std::string> analyzeSeminalBehavior(const std::string& filename) {
-    std::ifstream file(filename);
-    std::set<std::string> uniqueBehaviors;
-    std::string line;
-    bool inBranch = false;
-    std::set<std::string> fileVarsInBranch;
-    bool hasFileRead = false;
-    std::vector<std::string> branchLines;
-
-    if (!file.is_open()) {
-        return {};
-    }
-
-    while (std::getline(file, line)) {
-        // Check for new branch
-        if (line.find("Branch is seminal") != std::string::npos) {
-            // Process previous branch
-            for (const auto& fileVar : fileVarsInBranch) {
-                string mf = fileVar;
-                if(fileVar.find("opened in") != std::string::npos) {
-                    size_t pos = fileVar.find("opened in");
-                    mf = fileVar.substr(0, pos);
-                }
-                if (hasFileRead) {
-                    uniqueBehaviors.insert("size of " + mf);
-                }
-                uniqueBehaviors.insert(mf);
+        // the input's line is part of the text, so two calls reading the same
+        // variable are told apart
+        string render_input_source(int source) {
+            const input_source &src = input_sources[source];
+            string var = names.str(src.var).str();
+            string at = " on line " + std::to_string(function_calls.line[src.call]);
+            if (src.kind == SRC_SCANF) return "#:" + var + " gets value from user input via scanf" + at;
+            if (src.kind == SRC_INPUT) return "#: " + var + " gets value from user input" + at;
+            if (src.kind == SRC_FOPEN)
+                return "#: " + var + " gets value from file at path " + names.str(src.path).str() + " opened in mode " + names.str(src.mode).str() + at;
+            return "#: " + var + " gets value from file buffer named " + names.str(src.path).str() + at;
+        }
+
+        // the text of one step of an explanation
+        void render_step(const prov_step &st, vector<string> &out) {
+            const flow_node &fn = flow_nodes[st.node];
+            string name = names.str(fn.name).str();
+            if (st.edge == -1) {
+                out.push_back(render_input_source(st.source));
+                return;
             }
-            
-            // Reset for new branch
-            inBranch = true;
-            fileVarsInBranch.clear();
-            hasFileRead = false;
-            branchLines.clear();
-            continue;
-        }
-
-        // Skip if not in a branch or line is empty
-        if (!inBranch || line.empty()) continue;
-
-        // Check if line belongs to current branch (has 2 spaces at start)
-        if (line.find("  ") == 0) {
-            branchLines.push_back(line);
-
-            // Check for file read operations (gets value from file buffer OR gets value from each character)
-            if (line.find("gets value from file buffer") != std::string::npos ||
-                (line.find("#") != std::string::npos && line.find("gets value from each character") != std::string::npos)) {
-                hasFileRead = true;
-            }
-
-            // Check for scanf operations (marked with #)
-            if (line.find("#") != std::string::npos && line.find("scanf") != std::string::npos) {
-                size_t varStart = line.find(":") + 1;
-                size_t varEnd = line.find("gets") - 1;
-                if (varStart != std::string::npos && varEnd != std::string::npos) {
-                    std::string variable = line.substr(varStart, varEnd - varStart);
-                    variable = variable.substr(variable.find_first_not_of(" "), 
-                                            variable.find_last_not_of(" ") + 1);
-                    if (!variable.empty()) {
-                        uniqueBehaviors.insert(variable);
-                    }
+            const flow_edge &edge = edges_of(st.node)[st.edge];
+            if (edge.call != -1 && edge.descends) {
+                string callee = names.str(function_calls.name[edge.call]).str();
+                out.push_back(name + " is passed by address to function " + callee + " as " + names.str(flow_nodes[edge.target].name).str());
+            } else if (edge.call != -1) {
+                string callee = names.str(function_calls.name[edge.call]).str();
+                string arg = names.str(flow_nodes[edge.target].name).str();
+                if (is_location(name))
+                    out.push_back(name + " is in parameter " + name.substr(0, location_base_length(name)) + " of function " + callee);
+                else
+                    out.push_back(name + " defined as a parameter in function " + callee);
+                out.push_back(name + " gets value from argument " + arg + " in function call to " + callee);
+            } else if (flow_nodes[edge.target].scope == SYM_MEMORY) {
+                out.push_back(name + " may be the same memory as " + names.str(flow_nodes[edge.target].name).str());
+            } else if (fn.scope == SYM_MEMORY) {
+                const flow_node &to = flow_nodes[edge.target];
+                out.push_back(name + " is accessed as " + names.str(to.name).str() + " in function " + names.str(to.scope).str());
+            } else if (edge.gets != -1) {
+                for (int ci : lookup_all(indexes.calls_by_line, get_infos.line[edge.gets])) {
+                    sym callee = function_calls.name[ci];
+                    ArrayRef<param> args = function_calls.args_of(ci);
+                    if ((callee == SYM_GETC || callee == SYM_FGETC) && !args.empty())
+                        out.push_back("#: " + name + " gets value from each character in variable called " + names.str(args[0].name).str());
                 }
             }
+        }
+
+        // steps that print the same: the same node reading the same input,
+        // bound at the same call, getting its value at the same store, or
+        // taking the same edge to a location or a memory object
+        bool same_step(const prov_step &a, const prov_step &b) {
+            if (a.node != b.node || (a.edge == -1) != (b.edge == -1)) return false;
+            if (a.edge == -1) return a.source == b.source;
+            const flow_edge &x = edges_of(a.node)[a.edge];
+            const flow_edge &y = edges_of(b.node)[b.edge];
+            if (x.call == -1 && x.gets == -1) return x.target == y.target;
+            return x.call == y.call && x.gets == y.gets && x.descends == y.descends;
+        }
+
+        // whether a step reads the contents of a file: the source is an fread
+        // buffer, or the line it gets its value at calls getc or fgetc
+        bool step_reads_file(const prov_step &st) {
+            if (st.edge == -1) return input_sources[st.source].kind == SRC_FREAD;
+            const flow_edge &edge = edges_of(st.node)[st.edge];
+            if (edge.call != -1 || edge.gets == -1) return false;
+            for (int ci : lookup_all(indexes.calls_by_line, get_infos.line[edge.gets])) {
+                sym callee = function_calls.name[ci];
+                if ((callee == SYM_GETC || callee == SYM_FGETC) && !function_calls.args_of(ci).empty())
+                    return true;
+            }
+            return false;
+        }
+
+        // forward mode: create and expand the flow node of every variable in the
+        // module, after those expand_branch made, so both modes number nodes
+        // and inputs alike. Targets created while expanding are expanded too.
+        void expand_module() {
+            for (int l = 0; l < variables_per_line.size(); l++) {
+                for (sym va : variables_per_line.vars_of(l))
+                    get_flow_node(va, variables_per_line.scope[l], variables_per_line.line_num[l]);
+            }
+            for (int v = 0; v < variable_infos.size(); v++) {
+                if (!reaching_defs_of(variable_infos.name[v], variable_infos.scope[v]))
+                    get_flow_node(variable_infos.name[v], variable_infos.scope[v], -1);
+            }
+            for (int n = 0; n < (int)flow_nodes.size(); n++)
+                expand_flow_node(n);
+        }
 
-            // Check for file operations with path
-            if (line.find("gets value from file at path") != std::string::npos) {
-                size_t pathStart = line.find("path") + 5;
-                size_t modeStart = line.find("mode") - 1;
-                if (pathStart != std::string::npos && modeStart != std::string::npos) {
-                    std::string filepath = line.substr(pathStart, modeStart - pathStart);
-                    filepath = filepath.substr(filepath.find_first_not_of(" "), 
-                                            filepath.find_last_not_of(" ") + 1);
-                    if (!filepath.empty() && filepath != "\"rb\"" && filepath != "\"wb\"") {
-                        fileVarsInBranch.insert(filepath);
+        // label every flow node with the inputs that can reach it, through the
+        // components of the graph (see reach_index). Nodes no input reaches are
+        // resolved right away, and every line gets the inputs of its variables.
+        void build_reach_index() {
+            reach.component.assign(flow_nodes.size(), -1);
+            reach.reaches.clear();
+            for_each_component(flow_nodes.size(), [&](int n) { return edges_of(n).size(); },
+                               [&](int n, size_t i) { return edges_of(n)[i].target; },
+                               [&](const vector<int> &members) {
+                int c = reach.reaches.size();
+                for (int n : members) reach.component[n] = c;
+                source_set label;
+                for (int n : members) {
+                    for (int src : flow_nodes[n].direct) label.insert(src);
+                    for (auto &edge : edges_of(n)) {
+                        int t = reach.component[edge.target];
+                        if (t != c) label.unite(reach.reaches[t]);
                     }
                 }
+                reach.reaches.push_back(std::move(label));
+            });
+
+            for (int n = 0; n < (int)flow_nodes.size(); n++) {
+                if (reach.of(n).empty()) flow_states[n].store(FLOW_RESOLVED);
             }
-        } else {
-            // Process the branch before moving to next
-            for (const auto& fileVar : fileVarsInBranch) {
-                string mf = fileVar;
-                if(fileVar.find("opened in") != std::string::npos) {
-                    size_t pos = fileVar.find("opened in");
-                    mf = fileVar.substr(0, pos);
-                }
-                if (hasFileRead) {
-                    uniqueBehaviors.insert("size of " + mf);
+
+            line_inputs.assign(variables_per_line.size(), source_set());
+            for (int l = 0; l < variables_per_line.size(); l++) {
+                for (sym va : variables_per_line.vars_of(l)) {
+                    int n = find_flow_node(va, variables_per_line.scope[l], variables_per_line.line_num[l]);
+                    if (n != -1) line_inputs[l].unite(reach.of(n));
                 }
-                uniqueBehaviors.insert(mf);
             }
-            inBranch = false;
-            branchLines.clear();
         }
-    }
 
-    // Process the last branch if exists
-    if (inBranch) {
-        for (const auto& fileVar : fileVarsInBranch) {
-            string mf = fileVar;
-            if(fileVar.find("opened in") != std::string::npos) {
-                size_t pos = fileVar.find("opened in");
-                mf = fileVar.substr(0, pos);
-            }
-            if (hasFileRead) {
-                uniqueBehaviors.insert("size of " + mf);
+        // forward mode: work out the chains of every node an input reaches at
+        // once, so branch queries only look them up
+        void propagate_forward(query_worker &qw) {
+            vector<int> tainted;
+            for (int n = 0; n < (int)flow_nodes.size(); n++) {
+                if (!reach.of(n).empty()) tainted.push_back(n);
             }
-            uniqueBehaviors.insert(mf);
+            solve_flow_region(tainted, qw);
+            qw.stats.nodes += tainted.size();
         }
-    }
 
-    return std::vector<std::string>(uniqueBehaviors.begin(), uniqueBehaviors.end());
-}
+        vector<source_set> line_inputs;  // per variables_per_line row, the inputs its variables can be reached by
+
+        // report every input that reaches a variable used on the branch line,
+        // each with the chain that explains it, into br: one trace per variable
+        // an input reaches. Text is only produced here, and a chain only prints
+        // the steps after those it shares with the chain printed just before it.
+        // Only reads the facts and the graph expand_branch built, so branches
+        // can be analyzed on several threads.
+        void analyze_branch(int line, const string &branch_id, branch_result &br, query_worker &qw) {
+            br.line = line;
+            br.branch_id = branch_id;
+            br.reads_file = false;
+            int l = find_line_index_in_variables_per_line(line);
+            if (l == -1) return;
+            if (line_inputs[l].empty()) return;
+
+            sym scope = variables_per_line.scope[l];
+            std::set<int> reported;
+            for (sym va : variables_per_line.vars_of(l)) {
+                int n = find_flow_node(va, scope, line);
+                resolve_flow_node(n, qw);
+                if (flow_nodes[n].sources.empty()) continue;
+
+                vector<string> trace;
+                vector<prov_step> prev;
+                for (auto &rs : flow_nodes[n].sources) {
+                    if (reported.insert(rs.source).second) br.sources.push_back(rs.source);
+                    br.inputs.insert(rs.source);
+                    vector<prov_step> chain = chain_of(n, rs.source);
+                    for (auto &st : chain) br.reads_file |= step_reads_file(st);
+                    size_t common = 0;
+                    while (common < prev.size() && common + 1 < chain.size() &&
+                           same_step(prev[common], chain[common]))
+                        common++;
+                    for (size_t i = common; i < chain.size(); i++)
+                        render_step(chain[i], trace);
+                    prev = chain;
+                }
+                br.traces.push_back(std::move(trace));
+            }
+        }
 
-    public:
-        PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM) {
+        // build the flow graph of the branches
+        void expand_branches(const vector<pair<int, string>> &branches) {
+            clear_flow_graph();
+            context_k = SeminalContext;
+            context_fallback = false;
+            contexts.limit = SeminalContextLimit;
+            for (auto &br : branches) expand_branch(br.first);
+            if (SeminalMode == SEARCH_FORWARD) expand_module();
+            if (contexts.overflowed) {
+                // too many calling contexts: start over with every caller
+                context_k = 0;
+                context_fallback = true;
+                clear_flow_graph();
+                for (auto &br : branches) expand_branch(br.first);
+                if (SeminalMode == SEARCH_FORWARD) expand_module();
+            }
+        }
 
-            std::ofstream file("def-use-out.txt", std::ofstream::out | std::ofstream::trunc);
-            file.close();
-             // Track global variables first
-            trackGlobalVariables(M);
+        // answer every branch query, on -seminal-threads threads, and keep the
+        // seminal ones in the order of their ids
+        void analyze_branches(const vector<pair<int, string>> &branches) {
+            flow_states = vector<std::atomic<uint8_t>>(flow_nodes.size());
+            for (auto &st : flow_states) st.store(FLOW_UNRESOLVED);
+            build_reach_index();
+
+            unsigned threads = std::max<size_t>(1, std::min<size_t>(SeminalThreads, branches.size()));
+            vector<query_worker> workers(threads);
+            for (auto &qw : workers) qw.seen.assign(flow_nodes.size(), 0);
+            if (SeminalMode == SEARCH_FORWARD) propagate_forward(workers[0]);
+            vector<branch_result> results(branches.size());
+            query_pool.run(threads, branches.size(), [&](unsigned w, size_t i) {
+                analyze_branch(branches[i].first, branches[i].second, results[i], workers[w]);
+            });
+
+            for (auto &br : results) {
+                if (!br.traces.empty()) branch_results.push_back(std::move(br));
+            }
+            for (auto &qw : workers) {
+                search_stats.queries += qw.stats.queries;
+                search_stats.nodes += qw.stats.nodes;
+                search_stats.discover_high_water = std::max(search_stats.discover_high_water, qw.stats.discover_high_water);
+                search_stats.propagate_high_water = std::max(search_stats.propagate_high_water, qw.stats.propagate_high_water);
+            }
+        }
 
-            for(unsigned int ii=0; ii<1000; ii++) loop_map[ii] = 0;
-            
-            vector<pair<int, string>> ttt = readBranchInfo();
-            // targetLines = readBranchInfo();
+        worklist_stats search_stats = {0, 0, 0, 0};
+        work_stealing_pool query_pool;
+        unsigned context_k = 0;         // calls kept in a calling context, 0 once the search falls back to every caller
+        bool context_fallback = false;  // the search hit -seminal-context-limit
 
-            for (Function &F : M) {
-                if (F.isDeclaration())
-                    continue;
+        bool debug = false;
 
-                FunctionAnalysisManager &FAM = 
-                    AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
-                LoopInfo &LI = FAM.getResult<LoopAnalysis>(F);
-                    
-                for (BasicBlock &BB : F) {
-                    for (Instruction &I : BB) {
-                        getVariableNamesAtLine(I, F, LI);
+        vector<branch_result> branch_results;  // seminal branches, in the order they were analyzed
+
+        // the seminal behaviors: every variable read by scanf, and every file
+        // opened with fopen on a branch's chains, plus the size of that file
+        // when the branch also reads file contents
+        std::vector<std::string> seminalBehaviors() {
+            std::set<std::string> uniqueBehaviors;
+            for (const branch_result &br : branch_results) {
+                for (int s : br.inputs.members()) {
+                    const input_source &src = input_sources[s];
+                    if (src.kind == SRC_SCANF) {
+                        uniqueBehaviors.insert(names.str(src.var).str());
+                    } else if (src.kind == SRC_FOPEN) {
+                        // paths are reported with a trailing space, as they always were
+                        string path = names.str(src.path).str() + " ";
+                        uniqueBehaviors.insert(path);
+                        if (br.reads_file) uniqueBehaviors.insert("size of " + path);
                     }
                 }
             }
+            return std::vector<std::string>(uniqueBehaviors.begin(), uniqueBehaviors.end());
+        }
 
-            for (const auto& lineEntry : lineToVars) {
-                line_map lm;
-                lm.line_num = lineEntry.first;
-                lm.vars = std::vector<variable>();
-                if (!lineEntry.second.empty()) {
-                    for (const auto &varName : lineEntry.second) 
-                        lm.vars.push_back({varName});
+        // write the traces of every seminal branch to path in one go, a block
+        // per variable of the branch line. A block already written for the
+        // line is skipped, and a step is written once per block: chains that
+        // end the same way print the same steps.
+        void writeDefUse(const std::string &path) {
+            std::error_code EC;
+            raw_fd_ostream out(path, EC, sys::fs::OF_Text);
+            if (EC) {
+                errs() << "Error: Could not write " << path << ": " << EC.message() << "\n";
+                return;
+            }
+            for (const branch_result &br : branch_results) {
+                std::set<vector<string>> written;
+                for (auto &trace : br.traces) {
+                    vector<string> block;
+                    std::set<string> seen;
+                    for (auto &ss : trace)
+                        if (seen.insert(ss).second) block.push_back(ss);
+                    if (!written.insert(block).second) continue;
+
+                    out << "Branch is seminal source code line: " << br.line << " branch ID: " << br.branch_id << "\n";
+                    for (auto &ss : block) {
+                        out << "  " << ss << "\n";
+                    }
+                    out << "\n";
                 }
-                lm.part_of_loop = loop_map[lm.line_num];
-                variables_per_line.push_back(lm);
             }
-    
+        }
+
+        bool globals_collected = false;
+
+        // collect the facts of the functions in fns, add them to those
+        // collected before, and index them all
+        void collect_facts(Module &M, FunctionAnalysisManager &FAM, const vector<Function*> &fns) {
+            // Track global variables first, in the first round
+            bool first = !globals_collected;
+            globals_collected = true;
+            if (first) trackGlobalVariables(M);
+
+            walk_functions(fns, [&](Function &F, function_facts &ff) {
+                ff.scope = ff.names.intern(F.getName());
+                if (SeminalThreads > 1) {
+                    DominatorTree DT(F);
+                    LoopInfo LI(DT);
+                    collectLoopIntervals(F, LI, ff);
+                } else {
+                    collectLoopIntervals(F, FAM.getResult<LoopAnalysis>(F), ff);
+                }
+                
+                for (BasicBlock &BB : F) {
+                    for (Instruction &I : BB) {
+                        getVariableNamesAtLine(I, ff);
+                    }
+                }
+            });
+            for (auto &li : loop_intervals) li.second.build();
+            build_line_table();
+
             // First analyze global variables
-            analyzeGlobalVariables(M);
-            
+            if (first) analyzeGlobalVariables(M);
+        
             // Second pass: Function trace analysis
-            for (Function& F : M) {
-                if (!F.isDeclaration()) {
-                    printFunctionHeader(F);
-                    
-                    for (BasicBlock& BB : F) {
-                        for (Instruction& I : BB) {
-                            processInstruction(&I);
-                        }
+            walk_functions(fns, [&](Function &F, function_facts &ff) {
+                printFunctionHeader(F, ff);
+                recordRemovedFunctions(F, ff);
+                recordInlinedCalls(F, ff);
+                if (SeminalDefs == DEFS_REACHING) collectReachingDefs(F, ff);
+                
+                for (BasicBlock& BB : F) {
+                    for (Instruction& I : BB) {
+                        processInstruction(&I, ff);
                     }
                 }
-            }
+            });
 
-            vector<pair<int, string>> scope_map;
-            for (auto &f: functions) {
-                if (f.name.empty()) continue;  // Skip if name is empty
-                scope_map.push_back({f.line_num, f.name});
+            variable_infos.group_gets(get_infos);
+            build_call_indexes();
+
+            // an argument only counts on its line if the function returns
+            // something that depends on it
+            summarize_functions();
+            for (const arg_use &au : arg_uses) {
+                if (returns_argument(au.callee, au.pos)) lineToVars[au.line].insert(au.var);
+            }
+            build_line_table();
+            // the lines of functions collected later move the rows of the table
+            for (int g = 0; g < get_infos.size(); g++)
+                get_infos.line_row[g] = find_line_index_in_variables_per_line(get_infos.line[g]);
+
+            vector<pair<int, sym>> scope_map;
+            for (int f = 0; f < functions.size(); f++) {
+                if (functions.name[f] == SYM_EMPTY) continue;  // Skip if name is empty
+                scope_map.push_back({functions.line_num[f], functions.name[f]});
             }
 
             // Sort scope_map by line numbers to ensure proper ordering
             std::sort(scope_map.begin(), scope_map.end());
 
             if (!scope_map.empty()) {  // Only proceed if we have valid scopes
-                int minn = scope_map[0].first;
-                int maxx = scope_map[scope_map.size()-1].first;
-                
                 for (int v = 0; v < variables_per_line.size(); v++) {
-                    line_map &current_line = variables_per_line[v];
-                    int ln = current_line.line_num;
-                    
+                    int ln = variables_per_line.line_num[v];
+                
                     // Default to global scope
-                    current_line.scope = "global";
-                    
+                    variables_per_line.scope[v] = SYM_GLOBAL;
+                
                     // Find appropriate scope
                     for (size_t i = 0; i < scope_map.size(); i++) {
                         if (ln >= scope_map[i].first && 
                             (i == scope_map.size()-1 || ln < scope_map[i+1].first)) {
-                            current_line.scope = scope_map[i].second;
+                            variables_per_line.scope[v] = scope_map[i].second;
                             break;
                         }
                     }
+                    // the loops of the function the line is in
+                    variables_per_line.part_of_loop[v] = line_in_loop(variables_per_line.scope[v], ln);
+                }
+            }
+
+            build_location_index();
+            build_memory_index();
+        }
+
+    public:
+        void run(Module &M, ModuleAnalysisManager &AM) {
+            layout = &M.getDataLayout();
+            module = &M;
+
+            vector<Function*> defined;
+            for (Function &F : M) {
+                if (!F.isDeclaration()) {
+                    defined.push_back(&F);
+                    if (DISubprogram* SP = F.getSubprogram()) outlined.insert(SP);
+                }
+            }
+
+            // the analysis manager is not thread safe: threads build the
+            // loop info they need themselves, and the debug variable index has
+            // a slot for every function before they start
+            if (SeminalThreads > 1) {
+                for (Function *F : defined) debug_index[F];
+            }
+            for (size_t i = 0; i < defined.size(); i++) function_order.emplace(defined[i], i);
+            buildPointsTo(defined);
+            vector<pair<int, string>> ttt = branchLines();
+            FunctionAnalysisManager &FAM = 
+                AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+
+            // with -seminal-demand only the functions of the branches are
+            // walked at first. The functions the search reaches edges into
+            // but were not walked are added, their facts are added to those
+            // collected so far and the graph is built again, until the search
+            // needs no more.
+            if (!SeminalDemand) {
+                walked.insert(defined.begin(), defined.end());
+            } else {
+                for (auto &br : ttt) {
+                    if (Function* F = functionAtLine(defined, br.first)) add_to_slice(F);
+                }
+            }
+            std::unordered_set<const Function*> collected;
+            for (;;) {
+                demand_rounds++;
+                vector<Function*> slice;
+                for (Function* F : defined) {
+                    if (walked.count(F) && collected.insert(F).second) slice.push_back(F);
                 }
+                collect_facts(M, FAM, slice);
+                expand_branches(ttt);
+                if (demanded.empty()) break;
+                for (auto &d : demanded) add_to_slice(d.second);
+                demanded.clear();
             }
 
             if(debug){
@@ -980,12 +2857,15 @@ namespace {
                 errs() << "Variables defined at each line\n";
 
                 // print variables per line
-                for (auto &vp : variables_per_line) {
-                    errs() << "Line: " << vp.line_num << "\n";
-                    errs() << "  Part of Loop: " << vp.part_of_loop << "\n";
-                    errs() << "  Scope: " << vp.scope << "\n";
-                    for (auto &va : vp.vars) {
-                        errs() << "  Variable: " << va.name << "\n";
+                for (int l = 0; l < variables_per_line.size(); l++) {
+                    errs() << "Line: " << variables_per_line.line_num[l] << "\n";
+                    errs() << "  Part of Loop: " << variables_per_line.part_of_loop[l] << "\n";
+                    auto li = loop_intervals.find(variables_per_line.scope[l]);
+                    if (li != loop_intervals.end() && variables_per_line.part_of_loop[l])
+                        errs() << "  Loop Depth: " << li->second.depth_at(variables_per_line.line_num[l]) << "\n";
+                    errs() << "  Scope: " << names.str(variables_per_line.scope[l]) << "\n";
+                    for (sym va : variables_per_line.vars_of(l)) {
+                        errs() << "  Variable: " << names.str(va) << "\n";
                     }
                 }
 
@@ -993,10 +2873,14 @@ namespace {
                 errs() << "---------\n\n";
 
                 // print function info
-                for (auto &fi : functions) {
-                    errs() << "Function: " << fi.name << " defined at line " << fi.line_num << "\n";
-                    for (auto &pa : fi.args) {
-                        errs() << "  Argument: " << pa.name << " at position " << pa.id << "\n";
+                for (int f = 0; f < functions.size(); f++) {
+                    errs() << "Function: " << names.str(functions.name[f]) << " defined at line " << functions.line_num[f] << "\n";
+                    for (auto &pa : functions.args_of(f)) {
+                        errs() << "  Argument: " << names.str(pa.name) << " at position " << pa.id << "\n";
+                    }
+                    const vector<bool> &rp = summaries[f].returns_param;
+                    for (size_t i = 0; i < rp.size(); i++) {
+                        if (rp[i]) errs() << "  Returns a value depending on the argument at position " << i << "\n";
                     }
                 }
 
@@ -1004,13 +2888,13 @@ namespace {
                 errs() << "---------\n\n";
 
                 // print variable info
-                for (auto &vi : variable_infos) {
-                    errs() << "Variable: " << vi.name << " defined at line " << vi.defined_at_line << " with scope: "<<vi.scope << "\n";
-                    for (auto &gl : vi.gets_value_infos) {
-                        errs() << "  Gets value at line " << gl.gets_at_line << " with type " << gl.type << " and code " << gl.code << "\n";
+                for (int v = 0; v < variable_infos.size(); v++) {
+                    errs() << "Variable: " << names.str(variable_infos.name[v]) << " defined at line " << variable_infos.defined_at_line[v] << " with scope: "<<names.str(variable_infos.scope[v]) << "\n";
+                    for (int g : variable_infos.gets_of(v)) {
+                        errs() << "  Gets value at line " << get_infos.line[g] << " with type " << store_kind_name(get_infos.kind[g]) << " and code " << renderGetCode(g) << "\n";
                         errs() << "    Variables on this line: \n";
-                        for (auto &va : gl.vars.vars) {
-                            errs() << "      " << va.name << " scope: "<<gl.vars.scope << "\n";
+                        for (sym va : variables_per_line.vars_of(get_infos.line_row[g])) {
+                            errs() << "      " << names.str(va) << " scope: "<<names.str(get_infos.scope[g]) << "\n";
                         }
                     }
                 }
@@ -1019,46 +2903,81 @@ namespace {
                 errs() << "--------------\n\n";
 
                 // print function call info
-                for (auto &fci : function_calls) {
-                    errs() << "Function call: " << fci.name << " at line " << fci.line << " with scope: "<<fci.scope << "\n";
-                    for (auto &pa : fci.args) {
-                        errs() << "  Argument: " << pa.name << " at position " << pa.id << "\n";
+                for (int c = 0; c < function_calls.size(); c++) {
+                    errs() << "Function call: " << names.str(function_calls.name[c]) << " at line " << function_calls.line[c] << " with scope: "<<names.str(function_calls.scope[c]) << "\n";
+                    for (auto &pa : function_calls.args_of(c)) {
+                        errs() << "  Argument: " << names.str(pa.name) << " at position " << pa.id << "\n";
                     }
                 }
                 
+                errs() << "\nBRANCHES\n";
+                errs() << "--------\n\n";
+
+                // print every branch found
+                for (size_t b = 0; b < branch_sites.size(); b++) {
+                    errs() << "Branch: br_" << b + 1 << " in " << names.str(branch_sites[b].file)
+                           << " at line " << branch_sites[b].line << "\n";
+                }
+
                 errs() << "\n\n\n";
             }
 
-            for (auto tt : ttt) {
-                int tl = tt.first;
-                string branch_id = tt.second;
-                // find variables per line on line tl
-                current_line = tl;
-                current_branch_id = branch_id;
-                // errs() << "Analyzing line: " << tl << " branch ID: "<< branch_id << "\n";
-                // if(loop_map[tl] == 0) continue;
-                seminal_output[tl] = vector<string>();
-                for (auto &vp : variables_per_line) {
-                    visited.clear();
-                    if(vp.line_num == tl) {
-                        for (auto va : vp.vars) {
-                            seminal = false;
-                            vector<string> s;
-                            do_analysis(va.name, vp.scope, s);
-                        }
-                    }
+            analyze_branches(ttt);
+
+            if (debug || SeminalStats) {
+                errs() << "Branches: " << branch_sites.size() << " found, " << ttt.size() << " lines analyzed\n";
+                if (SeminalDemand)
+                    errs() << "Demand: " << walked.size() << " of " << defined.size() << " functions walked in "
+                           << demand_rounds << " rounds\n";
+                errs() << "Function summaries: " << functions.size() << " functions in " << summary_stats.components
+                       << " call graph components (" << summary_stats.recursive << " recursive), "
+                       << summary_stats.rounds << " rounds\n";
+                size_t classes = 0, targets = 0;
+                for (size_t n = 0; n < points_to.size(); n++) classes += points_to.class_of(n) == (int)n;
+                for (auto &ct : call_targets) targets += ct.second.size();
+                errs() << "Points-to: " << points_to.size() << " nodes in " << classes << " classes, "
+                       << points_to_objects.size() << " objects, " << call_targets.size()
+                       << " calls through pointers to " << targets << " functions\n";
+                if (SeminalContext > 0) {
+                    if (context_fallback)
+                        errs() << "Calling contexts: more than " << SeminalContextLimit << ", fell back to every caller\n";
+                    else
+                        errs() << "Calling contexts: " << contexts.size() << " of at most " << SeminalContext << " calls\n";
+                }
+                errs() << "Flow graph: " << flow_nodes.size() << " nodes, " << flow_edges.size() << " edges in "
+                       << reach.reaches.size() << " components\n";
+                errs() << "Def-use search (" << (SeminalMode == SEARCH_FORWARD ? "forward" : SeminalVisitOrder == VISIT_BFS ? "bfs" : "dfs") << "): "
+                       << search_stats.queries << " queries, " << search_stats.nodes << " nodes resolved, "
+                       << "discover worklist high water " << search_stats.discover_high_water << ", "
+                       << "propagate worklist high water " << search_stats.propagate_high_water << "\n";
+                for (size_t w = 0; w < query_pool.usage.size(); w++) {
+                    const worker_usage &u = query_pool.usage[w];
+                    errs() << "  query thread " << w << ": " << u.tasks << " branches (" << u.stolen << " stolen), busy "
+                           << format("%.3f", u.busy * 1000) << " ms of " << format("%.3f", query_pool.wall * 1000) << " ms ("
+                           << format("%.0f", query_pool.wall > 0 ? 100 * u.busy / query_pool.wall : 0.0) << "%)\n";
                 }
             }
 
-            // call analyzeSeminalBehavior
-            vector<string> uniqueBehaviors = analyzeSeminalBehavior("def-use-out.txt");
-            // print unique behaviors
-            errs() << "Final seminal behavior:\n";
+            if (!SeminalDefUseOut.empty())
+                writeDefUse(SeminalDefUseOut);
+
+            vector<string> uniqueBehaviors = seminalBehaviors();
+            // print unique behaviors, in one write so modules analyzed at the
+            // same time don't interleave their lines
+            string report;
+            raw_string_ostream os(report);
+            os << "Final seminal behavior:\n";
             for (const std::string& behavior : uniqueBehaviors) {
-                errs() << "  " << behavior << "\n";
+                os << "  " << behavior << "\n";
             }
-            
-            
+            errs() << os.str();
+        }
+    };
+
+    struct SeminalPass : public PassInfoMixin<SeminalPass> {
+        PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM) {
+            module_analysis analysis;
+            analysis.run(M, AM);
             return PreservedAnalyses::all();
         }
     };
@@ -1072,8 +2991,12 @@ llvmGetPassPluginInfo() {
         .PluginVersion = "v0.1",
         .RegisterPassBuilderCallbacks = [](PassBuilder &PB) {
             PB.registerPipelineStartEPCallback(
-                [](ModulePassManager &MPM, OptimizationLevel Level) {
-                    MPM.addPass(SeminalPass());
+                [](ModulePassManager &MPM, OptimizationLevel) {
+                    if (SeminalIR == IR_MEMORY) MPM.addPass(SeminalPass());
+                });
+            PB.registerOptimizerLastEPCallback(
+                [](ModulePassManager &MPM, OptimizationLevel) {
+                    if (SeminalIR == IR_SSA) MPM.addPass(SeminalPass());
                 });
         }
     };
@@ -1,12 +1,25 @@
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Pass.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/PassPlugin.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 #include <map>
 #include <string>
@@ -14,55 +27,949 @@
 #include <fstream>
 #include <vector>
 #include <sstream>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <tuple>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
 
 using namespace std;
 
+// Every variable name, scope, callee and argument text is interned once in
+// the string pool; facts hold its 32-bit id, so comparing or hashing a name
+// is an integer operation.
+typedef uint32_t sym;
+
+// ids of the strings the analysis itself looks for, interned first
+enum : sym {
+    SYM_EMPTY, SYM_GLOBAL, SYM_UNKNOWN,
+    SYM_SCANF, SYM_ISOC99_SCANF, SYM_FOPEN, SYM_FREAD, SYM_GETC, SYM_FGETC,
+    SYM_MEMORY      // scope of the flow nodes of memory objects
+};
+
+struct string_pool {
+    llvm::StringMap<sym> ids;           // owns the text
+    vector<llvm::StringRef> strings;    // id -> text
+
+    string_pool() {
+        for (const char *s : {"", "global", "unknown",
+                              "scanf", "__isoc99_scanf", "fopen", "fread", "getc", "fgetc", "<memory>"})
+            intern(s);
+    }
+
+    sym intern(llvm::StringRef s) {
+        auto r = ids.try_emplace(s, (sym)strings.size());
+        if (r.second) strings.push_back(r.first->getKey());
+        return r.first->second;
+    }
+
+    llvm::StringRef str(sym id) const { return strings[id]; }
+};
+
+// key of a (name, scope) pair in the hash indexes
+inline uint64_t sym_pair(sym a, sym b) { return (uint64_t)a << 32 | b; }
+
+// An abstract memory location is a variable followed by a constant path of
+// fields and array elements, every array index summarized as []:
+// "book.count", "accounts[].name". Its name is its key, interned like any
+// other name, and a location written to is a variable like any other; the
+// path is read back from the name, since '.' and '[' never occur in an
+// identifier.
+
+// length of the variable a location starts from
+inline size_t location_base_length(llvm::StringRef loc) {
+    return std::min(loc.find_first_of(".["), loc.size());
+}
+
+inline bool is_location(llvm::StringRef name) {
+    return location_base_length(name) < name.size();
+}
+
+// whether loc is a location below outer
+inline bool location_within(llvm::StringRef loc, llvm::StringRef outer) {
+    return loc.size() > outer.size() && loc.startswith(outer) && (loc[outer.size()] == '.' || loc[outer.size()] == '[');
+}
+
+// the location one step shorter, the variable itself after one step
+inline llvm::StringRef location_parent(llvm::StringRef loc) {
+    if (loc.endswith("[]")) return loc.drop_back(2);
+    size_t dot = loc.rfind('.');
+    return dot == llvm::StringRef::npos ? loc.take_front(0) : loc.take_front(dot);
+}
+
+// the location path leads to from the location name stands for. A pointer
+// stepped over stays in the array it points into, so "p[]" then "[]" is "p[]".
+// Following a recursive type, as a call to insert(node->left) from insert
+// does, would make a new location at every level: a field met again goes
+// back to where it was met first, so "node.left" then ".left.word" is
+// "node.left.word", and there are only as many locations as field orders.
+inline string location_append(llvm::StringRef name, llvm::StringRef path) {
+    if (name.endswith("[]") && path.startswith("[]")) path = path.drop_front(2);
+    string loc = (name + path).str();
+    llvm::StringRef rest = llvm::StringRef(loc).drop_front(location_base_length(loc));
+    string out = loc.substr(0, location_base_length(loc));
+    vector<size_t> fields;          // where each field on out starts
+    while (!rest.empty()) {
+        size_t next = rest.drop_front(1).find_first_of(".[");
+        size_t len = next == llvm::StringRef::npos ? rest.size() : next + 1;
+        llvm::StringRef step = rest.take_front(len);
+        rest = rest.drop_front(len);
+        if (step[0] == '.') {
+            auto again = std::find_if(fields.begin(), fields.end(), [&](size_t at) {
+                return llvm::StringRef(out).drop_front(at).startswith(step) &&
+                       (at + step.size() == out.size() || out[at + step.size()] == '.' || out[at + step.size()] == '[');
+            });
+            if (again != fields.end()) {
+                out.resize(*again + step.size());
+                fields.erase(again + 1, fields.end());
+                continue;
+            }
+            fields.push_back(out.size());
+        }
+        out += step.str();
+    }
+    return out;
+}
+
 typedef struct {
     int id;
-    string name;
+    sym name;
 } param;
 
+// Steensgaard's points-to analysis. Every abstract object (a variable, a
+// function, the memory one allocation call returns) and every pointer value
+// is a node, and a pointer's node is unified with the nodes of what it may
+// point to, so a class is memory that may be the same. A class has at most
+// one contents class, what the pointers stored in it point to; unifying two
+// classes unifies their contents too. Each constraint is a constant number of
+// unions, so the whole module takes near-linear time. Built once per module
+// and flattened, after which find is a lookup and the graph is only read.
+struct points_to_graph {
+    vector<int> parent;
+    vector<int> rank;
+    vector<int> contents;       // per class root, -1 while nothing is stored in it
+
+    int add() {
+        parent.push_back(parent.size());
+        rank.push_back(0);
+        contents.push_back(-1);
+        return parent.size() - 1;
+    }
+
+    int find(int n) {
+        int root = n;
+        while (parent[root] != root) root = parent[root];
+        while (parent[n] != root) {
+            int next = parent[n];
+            parent[n] = root;
+            n = next;
+        }
+        return root;
+    }
+
+    // the class of n, once flatten has run
+    int class_of(int n) const { return parent[n]; }
+
+    // the class the pointers stored in n point to, created on first use
+    int contents_of(int n) {
+        n = find(n);
+        if (contents[n] == -1) {
+            int c = add();
+            contents[n] = c;
+        }
+        return contents[n];
+    }
+
+    // unify the classes of a and b, and then their contents, without recursion
+    void join(int a, int b) {
+        vector<pair<int, int>> work = {{a, b}};
+        while (!work.empty()) {
+            a = find(work.back().first);
+            b = find(work.back().second);
+            work.pop_back();
+            if (a == b) continue;
+            if (rank[a] < rank[b]) std::swap(a, b);
+            parent[b] = a;
+            if (rank[a] == rank[b]) rank[a]++;
+            if (contents[a] == -1) contents[a] = contents[b];
+            else if (contents[b] != -1) work.push_back({contents[a], contents[b]});
+        }
+    }
+
+    // point every node straight at its class
+    void flatten() {
+        for (size_t n = 0; n < parent.size(); n++) find(n);
+    }
+
+    size_t size() const { return parent.size(); }
+};
+
+// The facts are kept in tables laid out as structure of arrays: one vector
+// per field, a row is an index into all of them. The variable length parts
+// of a row (the variables on a line, the arguments of a call, the gets of a
+// variable) are stored back to back in an arena owned by the table, and the
+// row holds its range into it. Rows refer to other tables by index, never by
+// copy.
+
+// [begin, end) range of an arena
+typedef struct {
+    uint32_t begin;
+    uint32_t end;
+} span;
+
+template <typename T>
+llvm::ArrayRef<T> arena_slice(const vector<T> &arena, span s) {
+    return llvm::ArrayRef<T>(arena).slice(s.begin, s.end - s.begin);
+}
+
+template <typename T>
+span arena_append(vector<T> &arena, llvm::ArrayRef<T> items) {
+    span s = {(uint32_t)arena.size(), (uint32_t)(arena.size() + items.size())};
+    arena.insert(arena.end(), items.begin(), items.end());
+    return s;
+}
+
+// Tarjan's algorithm over the graph of vertices 0..n-1 where vertex v has
+// degree(v) edges and its i-th edge goes to target(v, i). Calls
+// component(members) for every strongly connected component, each after all
+// the components it has an edge to. Uses an explicit stack, so deep graphs
+// do not overflow the call stack.
+template <typename Degree, typename Target, typename Component>
+void for_each_component(int n, Degree degree, Target target, Component component) {
+    vector<int> index(n, -1), low(n, 0);
+    vector<bool> on_stack(n, false);
+    vector<int> stack, members;
+    vector<pair<int, size_t>> path;     // (vertex, next edge to look at)
+    int next_index = 0;
+    auto enter = [&](int v) {
+        index[v] = low[v] = next_index++;
+        stack.push_back(v);
+        on_stack[v] = true;
+        path.push_back({v, 0});
+    };
+    for (int root = 0; root < n; root++) {
+        if (index[root] != -1) continue;
+        enter(root);
+        while (!path.empty()) {
+            int v = path.back().first;
+            if (path.back().second < degree(v)) {
+                int w = target(v, path.back().second++);
+                if (index[w] == -1) enter(w);
+                else if (on_stack[w]) low[v] = std::min(low[v], index[w]);
+                continue;
+            }
+            path.pop_back();
+            if (!path.empty()) {
+                int u = path.back().first;
+                low[u] = std::min(low[u], low[v]);
+            }
+            if (low[v] != index[v]) continue;
+            members.clear();
+            int w;
+            do {
+                w = stack.back();
+                stack.pop_back();
+                on_stack[w] = false;
+                members.push_back(w);
+            } while (w != v);
+            component(members);
+        }
+    }
+}
+
+// where a stored value comes from, ordered by how much it says
+enum store_kind { STORE_VAL, STORE_GEP, STORE_VAR, STORE_PARAM, STORE_FUNC };
+
+inline const char* store_kind_name(store_kind k) {
+    static const char *names[] = {"val", "gep", "var", "param", "func"};
+    return names[k];
+}
+
+// variables used on each source line
+struct line_table {
+    vector<int> line_num;
+    vector<sym> scope;
+    vector<int> part_of_loop;   // 1 if the line is in a loop of its function, 0 if not
+    vector<span> vars;          // into var_arena
+    vector<sym> var_arena;
+
+    int add(int line, llvm::ArrayRef<sym> names) {
+        line_num.push_back(line);
+        scope.push_back(SYM_GLOBAL);
+        part_of_loop.push_back(0);
+        vars.push_back(arena_append(var_arena, names));
+        return line_num.size() - 1;
+    }
+
+    llvm::ArrayRef<sym> vars_of(int l) const { return arena_slice(var_arena, vars[l]); }
+    int size() const { return line_num.size(); }
+
+    void clear() {
+        line_num.clear();
+        scope.clear();
+        part_of_loop.clear();
+        vars.clear();
+        var_arena.clear();
+    }
+};
+
+// function definitions and their parameters
+struct function_table {
+    vector<int> line_num;
+    vector<sym> name;
+    vector<span> args;          // into arg_arena
+    vector<param> arg_arena;
+
+    int add(int line, sym fname, llvm::ArrayRef<param> params) {
+        line_num.push_back(line);
+        name.push_back(fname);
+        args.push_back(arena_append(arg_arena, params));
+        return name.size() - 1;
+    }
+
+    llvm::ArrayRef<param> args_of(int f) const { return arena_slice(arg_arena, args[f]); }
+    int size() const { return name.size(); }
+};
+
+// function calls and the text of their arguments
+struct call_table {
+    vector<sym> name;
+    vector<sym> scope;
+    vector<int> line;
+    vector<span> args;          // into arg_arena
+    vector<param> arg_arena;
+
+    int add(sym callee, sym caller, int at_line, llvm::ArrayRef<param> params) {
+        name.push_back(callee);
+        scope.push_back(caller);
+        line.push_back(at_line);
+        args.push_back(arena_append(arg_arena, params));
+        return name.size() - 1;
+    }
+
+    llvm::ArrayRef<param> args_of(int c) const { return arena_slice(arg_arena, args[c]); }
+    int size() const { return name.size(); }
+};
+
+// one row per store to a known variable: where the variable gets a value
+struct get_table {
+    vector<int> var;                    // variable_infos row stored to
+    vector<int> line;                   // gets_at_line
+    vector<unsigned> col;
+    vector<store_kind> kind;            // from the stored value
+    vector<const llvm::Value*> value;   // the value operand of the store
+    vector<sym> file;                   // source file, only read when the code is rendered
+    vector<int> line_row;               // variables_per_line row of the line
+    vector<sym> scope;                  // scope the store is in
+    vector<bool> through;               // stored through the pointer the variable holds
+
+    int add(int v, int at_line, unsigned at_col, store_kind k, const llvm::Value* val,
+            sym in_file, int row, sym in_scope, bool via_pointer) {
+        var.push_back(v);
+        line.push_back(at_line);
+        col.push_back(at_col);
+        kind.push_back(k);
+        value.push_back(val);
+        file.push_back(in_file);
+        line_row.push_back(row);
+        scope.push_back(in_scope);
+        through.push_back(via_pointer);
+        return var.size() - 1;
+    }
+
+    int size() const { return var.size(); }
+};
+
+// variables, with their gets grouped per variable once collection is done
+struct variable_table {
+    vector<sym> name;
+    vector<sym> scope;
+    vector<int> defined_at_line;
+    vector<span> gets;          // into get_arena, filled by group_gets
+    vector<int> get_arena;      // get_table rows
+
+    int add(sym vname, sym vscope, int line) {
+        name.push_back(vname);
+        scope.push_back(vscope);
+        defined_at_line.push_back(line);
+        gets.push_back({0, 0});
+        return name.size() - 1;
+    }
+
+    // bucket the get rows by variable, keeping collection order in a bucket
+    void group_gets(const get_table &gt) {
+        vector<uint32_t> count(name.size() + 1, 0);
+        for (int v : gt.var) count[v + 1]++;
+        for (size_t v = 0; v < name.size(); v++) count[v + 1] += count[v];
+        for (size_t v = 0; v < name.size(); v++) gets[v] = {count[v], count[v + 1]};
+        get_arena.assign(gt.size(), 0);
+        for (int g = 0; g < gt.size(); g++) get_arena[count[gt.var[g]]++] = g;
+    }
+
+    llvm::ArrayRef<int> gets_of(int v) const { return arena_slice(get_arena, gets[v]); }
+    int size() const { return name.size(); }
+};
+
+enum source_kind {
+    SRC_SCANF,          // argument of scanf
+    SRC_INPUT,          // result of scanf
+    SRC_FOPEN,
+    SRC_FREAD
+};
+
+// An input the program reads that a variable can get its value from.
+typedef struct {
+    source_kind kind;
+    sym var;            // variable that gets the value
+    sym path;           // fopen: path, fread: buffer name
+    sym mode;           // fopen: mode
+    int call;           // index into function_calls
+} input_source;
+
+// A set of input sources, one bit per index into input_sources. Sets are
+// dense words so a union is a plain loop over words, which the compiler
+// vectorizes; a set only grows to the highest source it holds.
+struct source_set {
+    vector<uint64_t> words;
+
+    void insert(int s) {
+        size_t w = s / 64;
+        if (words.size() <= w) words.resize(w + 1, 0);
+        words[w] |= uint64_t(1) << (s % 64);
+    }
+
+    bool contains(int s) const {
+        size_t w = s / 64;
+        return w < words.size() && (words[w] >> (s % 64)) & 1;
+    }
+
+    bool empty() const {
+        uint64_t any = 0;
+        for (uint64_t w : words) any |= w;
+        return any == 0;
+    }
+
+    // add other to this set; whether that added anything
+    bool unite(const source_set &other) {
+        if (words.size() < other.words.size()) words.resize(other.words.size(), 0);
+        uint64_t added = 0;
+        const uint64_t *o = other.words.data();
+        uint64_t *w = words.data();
+        for (size_t i = 0, n = other.words.size(); i < n; i++) {
+            added |= o[i] & ~w[i];
+            w[i] |= o[i];
+        }
+        return added != 0;
+    }
+
+    // the sources in the set, in increasing order
+    vector<int> members() const {
+        vector<int> out;
+        for (size_t i = 0; i < words.size(); i++) {
+            for (uint64_t w = words[i]; w; w &= w - 1)
+                out.push_back(i * 64 + __builtin_ctzll(w));
+        }
+        return out;
+    }
+};
+
+// A value flow into a (variable, scope): either a parameter bound at a call
+// site, or the variables on a line the variable gets its value at.
 typedef struct {
-    string name;
-} variable;
+    int target;         // flow node the value comes from
+    int call;           // parameter edges: index into function_calls, -1 otherwise
+    int gets;           // line edges: row in get_infos
+    bool descends;      // parameter edges: into the callee the variable is passed to by address, not out to the caller
+} flow_edge;
+
+// Call strings of the k-limited context sensitive search: the calls, most
+// recent last, through which the search went down into the function a flow
+// node is in. Each is interned, so a context is an int; 0 is the empty
+// string, which stands for any caller. Only the k most recent calls are kept,
+// and once limit strings exist no more are made: the search then falls back
+// to every caller.
+struct call_strings {
+    vector<vector<int>> strings = {{}};
+    map<vector<int>, int> ids = {{{}, 0}};
+    size_t limit = 0;
+    bool overflowed = false;
+
+    int intern(const vector<int> &s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        if (strings.size() >= limit) {
+            overflowed = true;
+            return 0;
+        }
+        strings.push_back(s);
+        ids.emplace(s, strings.size() - 1);
+        return strings.size() - 1;
+    }
+
+    // ctx, then a call made in it, keeping the k most recent calls
+    int push(int ctx, int call, unsigned k) {
+        vector<int> s = strings[ctx];
+        s.push_back(call);
+        if (s.size() > k) s.erase(s.begin());
+        return intern(s);
+    }
+
+    // the most recent call of ctx, -1 for the empty string
+    int top(int ctx) const { return strings[ctx].empty() ? -1 : strings[ctx].back(); }
+
+    // ctx without its most recent call
+    int pop(int ctx) {
+        vector<int> s = strings[ctx];
+        if (!s.empty()) s.pop_back();
+        return intern(s);
+    }
 
+    size_t size() const { return strings.size(); }
+
+    void clear() {
+        strings.assign(1, vector<int>());
+        ids = {{{}, 0}};
+        overflowed = false;
+    }
+};
+
+// An input reaching a flow node, with the first step of its explanation.
+// Following the parents of that step ends at the node that reads the input.
 typedef struct {
-    int line_num;
-    string name;
-    vector<param> args;
-} func_map;
+    int source;         // index into input_sources
+    int length;         // edges on the way to the source
+    int chain;          // index into provenance.steps of the first step toward the source
+} reached_source;
 
+// The def-use search for one (variable, scope). Expanding it finds its edges
+// and the inputs it reads itself; resolving it finds every input it depends
+// on. The result is canonical: the shortest chain to each input, taking the
+// first edge (in edge order) on ties, so it does not matter which query
+// resolves a node or what was resolved before.
 typedef struct {
-    int line_num;
-    vector<variable> vars;
-    string scope;
-    int part_of_loop;
-} line_map;
+    sym name;
+    sym scope;
+    int var;                        // index into variable_infos, -1 if unknown
+    int line;                       // line the variable is read on, -1 for any
+    int context;                    // call_strings the function was entered through, 0 for any
+    bool expanded;
+    span edges;                     // into flow_edges, set when expanded
+    vector<int> direct;             // input_sources read by the variable itself
+    vector<reached_source> sources; // sorted by source, set once resolved
+} flow_node;
+
+// Which inputs can reach each flow node, built once the graph is expanded.
+// The graph is condensed into its strongly connected components, and each
+// component is labeled with the inputs read inside it or reaching a
+// component it has an edge to. Tarjan's algorithm finishes a component after
+// every component it reaches, so each label is one pass of set unions.
+struct reach_index {
+    vector<int> component;          // per flow node
+    vector<source_set> reaches;     // per component
+
+    const source_set& of(int n) const { return reaches[component[n]]; }
+};
+
+// Resolution state of a flow node, shared by the threads answering queries.
+// A node's sources are written by the one thread that moves it from
+// FLOW_UNRESOLVED to FLOW_PUBLISHING, and only read once it is FLOW_RESOLVED.
+enum flow_state { FLOW_UNRESOLVED, FLOW_PUBLISHING, FLOW_RESOLVED };
+
+// How the inputs reaching the branches are found. Backward searches from
+// the variables of each branch, resolving only what the branches depend on;
+// forward builds the flow graph of the whole module and pushes every input
+// through it once, after which a branch is a lookup. Both give the same
+// result.
+enum search_mode { SEARCH_BACKWARD, SEARCH_FORWARD };
+
+// Which assignments of a variable its value can come from. Lines takes every
+// assignment in the function, wherever it is. Reaching only takes the ones
+// that can reach the line the variable is read on, found by a reaching
+// definitions pass over each function's control flow graph; a flow node is
+// then a variable read on one line.
+enum def_mode { DEFS_LINES, DEFS_REACHING };
 
+// Which form of the IR the pass reads. Memory runs before the optimization
+// pipeline, where every variable lives in an alloca and is read and written
+// with loads and stores. SSA runs after it, once SROA and mem2reg have turned
+// most variables into SSA values that dbg.value ties to their variables.
+enum ir_mode { IR_MEMORY, IR_SSA };
+
+// One step of an explanation: node takes edge, with parent being the step
+// taken next (toward the input), or reads source itself if edge is -1.
 typedef struct {
-    int gets_at_line;
-    string type;
-    string code;
-    line_map vars;
-} get_list;
+    int node;           // index into flow_nodes
+    int edge;           // index into the node's edges
+    int source;         // index into input_sources, -1 unless edge is -1
+    int parent;         // index into provenance.steps, -1 if edge is -1
+} prov_step;
+
+// Hash-consed provenance steps. A step is stored once per (node, edge,
+// source, parent), so every chain that ends the same way shares that tail,
+// no matter how many variables or branches lead into it. Query threads add
+// steps while others read them, so both take the lock.
+struct provenance_arena {
+    struct key_hash {
+        size_t operator()(const std::tuple<int, int, int, int> &k) const {
+            uint64_t h = 0;
+            for (uint64_t v : {(uint64_t)std::get<0>(k), (uint64_t)std::get<1>(k),
+                               (uint64_t)std::get<2>(k), (uint64_t)std::get<3>(k)})
+                h = (h ^ v) * 0x100000001b3ULL;
+            return h;
+        }
+    };
+
+    vector<prov_step> steps;
+    unordered_map<std::tuple<int, int, int, int>, int, key_hash> ids;
+    std::unique_ptr<std::mutex> lock = std::make_unique<std::mutex>();
+
+    int intern(int node, int edge, int source, int parent) {
+        std::lock_guard<std::mutex> guard(*lock);
+        auto key = std::make_tuple(node, edge, source, parent);
+        auto it = ids.find(key);
+        if (it != ids.end()) return it->second;
+        steps.push_back({node, edge, source, parent});
+        ids.emplace(key, steps.size() - 1);
+        return steps.size() - 1;
+    }
+
+    void clear() {
+        steps.clear();
+        ids.clear();
+    }
+
+    // the steps of a chain, from its first step to the input
+    vector<prov_step> chain(int id) const {
+        std::lock_guard<std::mutex> guard(*lock);
+        vector<prov_step> out;
+        for (; id != -1; id = steps[id].parent) out.push_back(steps[id]);
+        return out;
+    }
+};
+
+// Order the def-use search discovers the flow nodes a query depends on in.
+// Breadth first finds close nodes first; depth first keeps the worklist
+// small on wide graphs. The explanations found are the same.
+enum visit_order { VISIT_BFS, VISIT_DFS };
 
+// A conditional branch, switch or select of the module, once for every
+// place it can go; its index in module order gives its id, br_<index + 1>.
 typedef struct {
-    string name;
-    string scope;
-    int defined_at_line;
-    vector<get_list> gets_value_infos;
-} var_map;
+    sym file;           // file the condition is in
+    unsigned line;      // line the condition is on
+} branch_site;
 
+// What the def-use search found for one branch.
 typedef struct {
-    string name;
-    vector<param> args;
-    string scope;
     int line;
-} func_call_map;
+    string branch_id;
+    vector<int> sources;    // input_sources reaching a variable on the line, in report order
+    source_set inputs;      // the same sources as a set: the inputs controlling the branch
+    bool reads_file;        // some chain reads a file's contents (fread, getc, fgetc)
+    vector<vector<string>> traces;  // printed explanation of each variable an input reaches, one entry per line
+} branch_result;
+
+// Worklist sizes seen while resolving flow nodes.
+typedef struct {
+    size_t queries;                 // calls to resolve_flow_node that did work
+    size_t nodes;                   // flow nodes resolved
+    size_t discover_high_water;     // largest node worklist
+    size_t propagate_high_water;    // most (node, source) candidates of one length
+} worklist_stats;
+
+// Work done by one thread of a work_stealing_pool.
+typedef struct {
+    size_t tasks;
+    size_t stolen;                  // tasks taken from another thread's queue
+    double busy;                    // seconds spent running tasks
+} worker_usage;
+
+// Runs tasks 0 .. n-1 on a fixed number of threads. Each thread starts with an
+// equal, contiguous share of the tasks in a queue of its own and runs them
+// front to back; once its queue is empty it steals from the back of the
+// others' queues, so no thread idles while work is left.
+struct work_stealing_pool {
+    struct task_queue {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    vector<worker_usage> usage;     // one per thread, after run
+    double wall = 0;                // seconds run took
+
+    void run(unsigned threads, size_t n, llvm::function_ref<void(unsigned, size_t)> task) {
+        threads = std::max(1u, threads);
+        usage.assign(threads, {0, 0, 0});
+        vector<std::unique_ptr<task_queue>> queues;
+        for (unsigned w = 0; w < threads; w++) {
+            queues.push_back(std::make_unique<task_queue>());
+            for (size_t i = n * w / threads; i < n * (w + 1) / threads; i++)
+                queues[w]->tasks.push_back(i);
+        }
+
+        auto take = [&](unsigned w, size_t &i) {
+            {
+                std::lock_guard<std::mutex> guard(queues[w]->lock);
+                if (!queues[w]->tasks.empty()) {
+                    i = queues[w]->tasks.front();
+                    queues[w]->tasks.pop_front();
+                    return true;
+                }
+            }
+            for (unsigned k = 1; k < threads; k++) {
+                task_queue &victim = *queues[(w + k) % threads];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (!victim.tasks.empty()) {
+                    i = victim.tasks.back();
+                    victim.tasks.pop_back();
+                    usage[w].stolen++;
+                    return true;
+                }
+            }
+            return false;
+        };
+        auto work = [&](unsigned w) {
+            size_t i;
+            while (take(w, i)) {
+                auto start = std::chrono::steady_clock::now();
+                task(w, i);
+                usage[w].busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                usage[w].tasks++;
+            }
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        vector<std::thread> workers;
+        for (unsigned w = 1; w < threads; w++) workers.emplace_back(work, w);
+        work(0);
+        for (auto &t : workers) t.join();
+        wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// the value a parameter of a function inlined into this one was given, at
+// the call it was inlined from
+typedef struct {
+    const llvm::DILocation* call;
+    const llvm::DILocalVariable* param;
+    llvm::Value* value;
+} inlined_arg;
+
+// Debug variables of one function, keyed by the IR value that describes
+// them. Filled by a single walk over the function, from dbg.declare /
+// dbg.value intrinsics and, on LLVM 19+, from debug records. Variables of a
+// function inlined into it that the module still defines belong to that
+// function and are left out; only the values its parameters were called
+// with are kept. Functions inlined everywhere and removed only live on in
+// the functions they were inlined into, so their variables are kept.
+struct function_debug_vars {
+    bool built = false;
+    unordered_map<const llvm::Value*, llvm::DILocalVariable*> declared;  // address (alloca) -> variable
+    unordered_map<const llvm::Value*, llvm::SmallVector<llvm::DILocalVariable*, 1>> values;  // SSA value -> variables
+    unordered_map<unsigned, llvm::DILocalVariable*> args;                // argument number (from 1) -> variable
+    vector<inlined_arg> inlined_args;   // in instruction order
+    vector<const llvm::DISubprogram*> removed;  // removed functions inlined into this one
+};
+
+typedef struct {
+    unsigned first_line;
+    unsigned last_line;
+    unsigned depth;     // 1 for an outermost loop
+} loop_interval;
+
+// Source line ranges of the loops of one function; lines of different
+// functions are not comparable, since they can be in different files.
+// After build(), the loops covering a line are found with one binary
+// search: the line axis is cut into segments at every interval end point,
+// and each segment keeps the loops that cover it.
+struct loop_interval_index {
+    vector<loop_interval> loops;
+    vector<unsigned> bounds;            // sorted start of each segment
+    vector<vector<int>> covering;       // loops covering [bounds[i], bounds[i + 1])
+
+    void add(unsigned first_line, unsigned last_line, unsigned depth) {
+        loops.push_back({first_line, last_line, depth});
+    }
+
+    void build() {
+        bounds.clear();
+        for (auto &l : loops) {
+            bounds.push_back(l.first_line);
+            bounds.push_back(l.last_line + 1);
+        }
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+        covering.assign(bounds.size(), vector<int>());
+        for (size_t j = 0; j < loops.size(); j++) {
+            size_t i = std::lower_bound(bounds.begin(), bounds.end(), loops[j].first_line) - bounds.begin();
+            for (; i < bounds.size() && bounds[i] <= loops[j].last_line; i++)
+                covering[i].push_back(j);
+        }
+    }
+
+    // indexes into loops of every loop whose range contains line
+    const vector<int>& loops_at(unsigned line) const {
+        static const vector<int> none;
+        auto it = std::upper_bound(bounds.begin(), bounds.end(), line);
+        if (it == bounds.begin()) return none;
+        return covering[it - bounds.begin() - 1];
+    }
+
+    bool in_loop(unsigned line) const { return !loops_at(line).empty(); }
+
+    // nesting depth of the innermost loop containing line, 0 if none
+    unsigned depth_at(unsigned line) const {
+        unsigned d = 0;
+        for (int j : loops_at(line)) d = std::max(d, loops[j].depth);
+        return d;
+    }
+};
+
+// A variable whose only use on a line is as an argument of a call to a
+// function defined in the module. It only counts as used on the line if the
+// value the function returns depends on that argument.
+typedef struct {
+    unsigned line;
+    sym var;
+    sym callee;
+    int pos;            // argument position
+} arg_use;
+
+// What a call to a defined function passes back to its caller: which of its
+// parameters the returned value depends on. Summaries are computed callees
+// first over the call graph, so a function's summary already uses those of
+// the functions it calls.
+typedef struct {
+    vector<unsigned> return_lines;  // lines that decide the returned value
+    vector<bool> returns_param;     // by argument position
+    bool done;
+} function_summary;
+
+// Keyed lookups over the vectors above. All values are indexes into those
+// vectors. Variables are indexed as they are added, since stores look them
+// up while we are still collecting; everything else is built once after
+// collection. Where several entries share a key, the vectors keep them in
+// collection order and the single-index maps keep the first one.
+struct fact_indexes {
+    unordered_map<sym, int> global_vars;                // name -> variable_infos
+    unordered_map<uint64_t, int> scoped_vars;           // sym_pair(name, scope) -> variable_infos
+    unordered_map<int, int> lines;                      // line -> variables_per_line
+    unordered_map<sym, int> functions_by_name;          // name -> functions
+    unordered_map<int, vector<int>> functions_by_line;  // line -> functions
+    unordered_map<int, vector<int>> calls_by_line;      // line -> function_calls
+    unordered_map<sym, vector<int>> calls_by_callee;    // callee -> function_calls
+    unordered_map<sym, vector<int>> calls_by_scope;     // caller -> function_calls
+    unordered_map<int, vector<int>> arg_uses_by_line;   // line -> arg_uses
+    unordered_map<sym, vector<int>> input_calls_by_scope; // scope -> scanf calls
+    unordered_map<uint64_t, vector<int>> flow_nodes;    // sym_pair(name, scope) -> flow_nodes, one per line read on
+    unordered_map<uint64_t, vector<pair<unsigned, unsigned>>> reaching_defs; // sym_pair(name, scope) -> sorted (line read on, line of a definition reaching it)
+    unordered_map<uint64_t, vector<sym>> locations_by_parent; // sym_pair(location or variable, scope) -> locations one step below it
+    unordered_set<uint64_t> pointer_vars;               // sym_pair(name, scope) of variables holding a pointer
+    unordered_map<uint64_t, vector<sym>> memory_of;     // sym_pair(name, scope) -> memory objects it may be
+    unordered_map<sym, vector<pair<sym, sym>>> memory_names; // memory object -> (name, scope) it is accessed as
+    unordered_set<sym> shared_memory;                   // memory objects accessed as more than one variable
+    map<std::tuple<int, int, sym>, int> sources;        // (kind, call, var) -> input_sources
+};
+
+// What one walk over one function found, before it is merged into the
+// module. Names are interned into the function's own pool so functions can
+// be walked on different threads; merging them in function order adds
+// everything to the module exactly as one serial walk would have.
+struct function_facts {
+    string_pool names;
+    sym scope = SYM_GLOBAL;                 // the function being walked
+    vector<loop_interval> loops;
+    vector<unsigned> lines;                 // lines that have code
+    vector<pair<unsigned, sym>> line_vars;  // (line, variable used on it)
+    vector<arg_use> arg_uses;               // variables on a line only passed to defined functions
+    vector<unsigned> return_lines;          // lines that decide the function's returned value
+    vector<std::tuple<sym, unsigned, unsigned>> reaching; // (variable, line read on, line of a definition reaching it)
+    vector<pair<sym, sym>> pointers;        // (variable, scope) of variables holding a pointer
+    vector<std::tuple<sym, sym, sym>> memory; // (variable or location, scope, memory object it may be)
+    function_table functions;               // the function itself, then removed functions inlined into it
+    variable_table vars;                    // variables declared in the function
+    unordered_map<uint64_t, int> var_index; // sym_pair(name, scope) -> first row in vars
+    get_table gets;                         // var: row in vars, or -1 - row of a global in variable_infos
+    call_table calls;
+};
+
+// Facts and search results of the module being analyzed. SeminalPass::run
+// creates a fresh one for every module and drops it when done, so nothing
+// is shared between modules and several can be analyzed at once.
+struct analysis_state {
+    string_pool names;                      // Text of every sym
+    line_table variables_per_line;          // Variables defined at each line
+    function_table functions;               // Functions and their arguments
+    variable_table variable_infos;          // Variables and their gets
+    get_table get_infos;                    // How each variable gets its value
+    call_table function_calls;              // Function calls and their arguments
+    vector<arg_use> arg_uses;               // Variables only passed to defined functions on a line
+    vector<std::tuple<sym, sym, sym>> memory_accesses; // (name, scope, memory object) from the points-to classes
+    vector<function_summary> summaries;     // Per function, what its returned value depends on
+    vector<input_source> input_sources;     // Inputs found by the def-use search
+    vector<flow_node> flow_nodes;           // Memoized def-use results per (variable, scope)
+    vector<flow_edge> flow_edges;           // Edges of the flow nodes, each node's side by side
+    call_strings contexts;                  // Calling contexts of the flow nodes
+    provenance_arena provenance;            // Explanations of how flow nodes reach their inputs
+    reach_index reach;                      // Inputs reaching each flow node
+    vector<std::atomic<uint8_t>> flow_states; // flow_state of each flow node, while queries run
+    fact_indexes indexes;
+};
+
+// Source text of every file named by a DILocation, loaded once per file.
+// Each file is loaded through llvm::MemoryBuffer (which mmaps files of 16 KiB
+// or more and reads smaller ones) and gets a table of line start offsets, so
+// fetching a line is a single lookup instead of a getline scan from the top of
+// the file.
+struct source_file {
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    vector<uint32_t> line_starts;   // offset of line N is line_starts[N - 1]
+};
+
+struct source_cache {
+    std::unordered_map<string, std::unique_ptr<source_file>> files;
+
+    // returns nullptr if the file could not be opened
+    const source_file* get_file(llvm::StringRef path) {
+        auto it = files.find(path.str());
+        if (it != files.end()) return it->second.get();
+
+        std::unique_ptr<source_file> sf;
+        auto buf = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                               /*RequiresNullTerminator=*/false);
+        if (buf) {
+            sf = std::make_unique<source_file>();
+            sf->buffer = std::move(*buf);
+            llvm::StringRef text = sf->buffer->getBuffer();
+            if (!text.empty()) sf->line_starts.push_back(0);
+            for (size_t i = 0; i < text.size(); i++) {
+                if (text[i] == '\n' && i + 1 < text.size())
+                    sf->line_starts.push_back(i + 1);
+            }
+        }
+        // failed opens are cached too so we don't retry them for every store
+        const source_file* res = sf.get();
+        files[path.str()] = std::move(sf);
+        return res;
+    }
 
-vector<line_map> variables_per_line;    // Variables defined at each line
-vector<func_map> functions;             // Functions and their arguments
-vector<var_map> variable_infos;              // Variables and their gets
-vector<func_call_map> function_calls;   // Function calls and their arguments
+    // line numbers start at 1, like DILocation. Returns false if the file or
+    // the line does not exist.
+    bool get_line(llvm::StringRef path, unsigned line, llvm::StringRef &out) {
+        const source_file* sf = get_file(path);
+        if (!sf || line == 0 || line > sf->line_starts.size()) return false;
 
-vector<string> input_functions = {"scanf", "fread", "fopen", "getc"};
\ No newline at end of file
+        llvm::StringRef text = sf->buffer->getBuffer();
+        size_t start = sf->line_starts[line - 1];
+        size_t end = line < sf->line_starts.size() ? sf->line_starts[line] - 1 : text.size();
+        if (line == sf->line_starts.size() && end > start && text[end - 1] == '\n') end--;
+        out = text.slice(start, end);
+        return true;
+    }
+};
@@ -0,0 +1,26 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+// stores a number read from the user where p points
+void read_number(int *p) {
+    int t;
+    scanf("%d", &t);
+    *p = t;
+}
+
+int main() {
+    int a;
+    int *h = (int *)malloc(sizeof(int));
+
+    read_number(&a);
+    read_number(h);
+
+    if (a > 0) {
+        printf("a is positive\n");
+    }
+    if (*h > 0) {
+        printf("h points to a positive number\n");
+    }
+    free(h);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <stdio.h>
+
+// reads a number from the user where p points
+void read_number(int *p) {
+    scanf("%d", p);
+}
+
+// stores v where p points
+void fill(int *p, int v) {
+    *p = v;
+}
+
+int main() {
+    int n, a, b;
+    read_number(&n);
+
+    fill(&a, n);
+    fill(&b, 7);
+
+    if (a > 0) {
+        printf("a is positive\n");
+    }
+    if (b > 0) {
+        printf("b is positive\n");
+    }
+    return 0;
+}
\ No newline at end of file